@@ -0,0 +1,453 @@
+/**
+ * Microbenchmarks for the engine hot paths, plus a fixed-depth bench
+ * search.
+ *
+ * Three fixed position sets, stored below as move lists after the opening
+ * cross.  They were drawn from random candidate moves with a seeded
+ * generator, and 'bench --make-positions' prints them again:
+ *   opening  : 2-6 plies after the cross
+ *   midgame  : 16-23 plies
+ *   tactical : 10-24 plies, the side to move has a four available
+ * In every set neither side has a win by threats.  That is checked with a
+ * small full-width df-pn search for each side, not with the ThreatSolver
+ * being measured, so a blind spot of the threat search cannot leave
+ * decided positions (a root mate and no search) in the sets.  Storing the
+ * sets keeps them, and so the bench signature, fixed when the solvers
+ * change.
+ *
+ * Every micro benchmark cycles over all positions and is repeated until it
+ * has run for at least min-ms; it reports ns/op and ops/sec:
+ *   Board::makeMove + unmakeMove, checkWin, isWinningMove, getCandidateMoves,
+ *   emptyCells, snapshot + restore,
+ *   ThreatSolver::analyzeThreats (cold: a fresh solver per position, and
+ *   warm: answered from the solver's ThreatCache), computeDefensiveSet,
+ *   TranspositionTable::probe and store, PatternEvaluator::evaluate (full
+ *   rebuild, and incremental notifyMove/evaluate/notifyUndo).
+ *
+ * The bench search then searches every position to a fixed depth with a
+ * fresh engine (single thread, no time limit) and prints the node count of
+ * each position, the total and the NPS.  The total depends only on the
+ * search code, so it is the signature to compare between builds: an
+ * optimisation that is not meant to change the search must keep it.
+ *
+ * Usage: bench [depth] [min-ms]      (defaults: 4, 200)
+ *        bench --make-positions     (print the generated sets)
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "core/board.h"
+#include "core/position_codec.h"
+#include "search_engine.h"
+#include "search/evaluator.h"
+#include "search/history_heuristic.h"
+#include "search/transposition_table.h"
+#include "tactics/dfpn_solver.h"
+#include "tactics/threat_solver.h"
+
+using namespace gomoku;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+static const unsigned SEED = 20240611u;
+static const int POSITIONS_PER_SET = 8;
+// df-pn budget per side of the "no win by threats" check.
+static const std::uint64_t QUIET_DFPN_NODES = 20000;
+
+// Keeps benchmarked results alive so the calls are not optimised away.
+volatile std::uint64_t g_sink = 0;
+
+struct Position {
+    std::string name;
+    std::string moves;  // after the opening cross, see parseMoveList()
+    Board       board;
+};
+
+// The position sets, written by 'bench --make-positions'.
+static const char* const OPENING_SET[POSITIONS_PER_SET] = {
+    "f8 e8",
+    "e7 e5 d4",
+    "h5 g5 e5 e8",
+    "h8 h7 g5 f4 h4",
+    "e7 g8 h9 f5 e4 e3",
+    "e5 d5",
+    "h8 h5 g4",
+    "h8 e8 d7 e6",
+};
+static const char* const MIDGAME_SET[POSITIONS_PER_SET] = {
+    "e5 f4 d4 d5 g5 h5 c4 d3 b3 a3 i4 g3 a4 i3 g2 c5",
+    "e7 e8 h8 d9 e5 e6 f4 h9 c9 h5 e4 b8 c8 c10 f8 i7 d8",
+    "h8 i8 j9 h7 h5 e8 d9 i4 i9 k9 h6 j10 c10 g8 h9 l10 h4 j3",
+    "h8 f8 i9 g8 e9 e5 h6 j10 g9 d9 f9 k11 d8 i7 h7 h5 i4 h9 d4",
+    "e8 e6 e9 f8 d6 c7 c6 d9 f10 b8 b6 h5 a8 c10 e5 d7 e7 a9 i4 f4",
+    "f8 e8 f9 h7 h6 i8 e7 d7 g8 g9 f5 g4 h8 e9 h4 h3 c7 b6 d8 f10 e11",
+    "e7 d8 d7 h6 e9 e6 e5 e8 d6 c7 g8 h7 b7 c5 c6 b5 i5 j6 f10 e4 k5 a4",
+    "e5 e4 d3 c2 e2 h7 i8 g8 b1 b2 e1 d1 e7 c3 e3 f4 d4 f5 a3 d6 g4 c1 h8",
+};
+static const char* const TACTICAL_SET[POSITIONS_PER_SET] = {
+    "g5 g8 e7 e8 h8 f4 d8 e6 h5 i5",
+    "e8 h5 e7 e6 h6 h4 i7 j8 g4 d5 e5 i6",
+    "e8 d7 d9 f8 e9 c10 c6 e6 d11 e10 g5 d6 g4 h5",
+    "f8 h7 i8 e7 d8 g8 e6 h5 e5 c8 c7 e9 i6 d6 e8 j8",
+    "e6 h6 f8 e8 i7 h5 j6 d5 k6 f9 e7 i5 h8 g9 e9 i8 h7 l6",
+    "f8 e9 h6 d8 d9 c10 d10 b9 a8 a7 b7 e8 b11 h7 f9 c11 i8 b12 e5 j8",
+    "e7 h7 h8 d6 g8 h9 c6 e8 i8 j8 d7 i6 h10 f5 i7 c7 f9 b5 i9 f10 b4 g9",
+    "h6 h7 e5 i6 e4 g5 f4 d6 j5 k5 g8 f3 e7 d4 k4 l4 l3 c5 b6 e6 c6 f8 f5 b7",
+};
+
+// Play random candidate moves until 'plies' have been played, without
+// completing a five, and append them to 'moves'.  Returns false if the
+// game ended early.
+bool playRandom(Board& board, std::string& moves, std::mt19937& rng, int plies) {
+    for (int i = 0; i < plies; ++i) {
+        MoveList candidates;
+        board.getCandidateMoves(candidates);
+        if (candidates.empty()) return false;
+        const Move m = candidates[rng() % candidates.size()];
+        if (board.isWinningMove(m.x, m.y, board.sideToMove())) return false;
+        board.makeMove(m.x, m.y);
+        if (!moves.empty()) moves += ' ';
+        moves += cellName(m);
+    }
+    return true;
+}
+
+bool hasWinningMove(const Board& board, Player p) {
+    MoveList candidates;
+    board.getCandidateMoves(candidates);
+    for (const Move& m : candidates) {
+        if (board.isWinningMove(m.x, m.y, p)) return true;
+    }
+    return false;
+}
+
+// Neither side has a win by threats: full-width df-pn disproves both
+// within its budget (a position it cannot settle is rejected too), so the
+// search, not the root threat analysis, decides the move.  The threat
+// solver only saves time here: most random positions are wins it finds
+// quickly.  It can reject a position but never accept one.
+bool isQuiet(ThreatSolver& solver, DfpnSolver& dfpn, const Board& board) {
+    if (hasWinningMove(board, Player::Black) || hasWinningMove(board, Player::White)) return false;
+    solver.syncFromBoard(board);
+    if (solver.analyzeThreats(board, Player::Black).attackerHasForcedWin ||
+        solver.analyzeThreats(board, Player::White).attackerHasForcedWin) {
+        return false;
+    }
+    DfpnLimits limits;
+    limits.maxNodes         = QUIET_DFPN_NODES;
+    limits.fullWidthDefence = true;
+    return dfpn.solve(board, Player::Black, limits).status == DfpnStatus::Disproven &&
+           dfpn.solve(board, Player::White, limits).status == DfpnStatus::Disproven;
+}
+
+// Draw the set 'name': position i is 'plies(i)' random plies that 'accept'
+// takes.
+template <typename Plies, typename Accept>
+void drawSet(std::mt19937& rng, const char* name, Plies plies, Accept accept,
+             std::vector<Position>& out) {
+    for (int i = 0; i < POSITIONS_PER_SET; ++i) {
+        Position p;
+        p.name = std::string(name) + "-" + std::to_string(i);
+        do {
+            p.board = Board();
+            p.moves.clear();
+        } while (!playRandom(p.board, p.moves, rng, plies(i)) || !accept(p.board));
+        out.push_back(p);
+    }
+}
+
+// The seeded generator behind the sets (slow: about a minute, almost all
+// of it in df-pn).
+std::vector<Position> generatePositions() {
+    std::vector<Position> out;
+    std::mt19937 rng(SEED);
+    // One solver of each kind for all the checks: construction is costly.
+    const Board start;
+    ThreatSolver threats(start);
+    DfpnSolver dfpn;
+    const auto quiet = [&](const Board& b) { return isQuiet(threats, dfpn, b); };
+
+    drawSet(rng, "opening", [](int i) { return 2 + i % 5; }, quiet, out);
+    drawSet(rng, "midgame", [](int i) { return 16 + i; }, quiet, out);
+    drawSet(rng, "tactical", [](int i) { return 10 + 2 * i; }, [&](const Board& b) {
+        threats.syncFromBoard(b);
+        ForcingMoves forcing;
+        threats.collectForcingMoves(b, b.sideToMove(), forcing);
+        return !forcing.fours.empty() && quiet(b);
+    }, out);
+    return out;
+}
+
+void printPositions(const std::vector<Position>& positions) {
+    const char* const sets[] = {"OPENING_SET", "MIDGAME_SET", "TACTICAL_SET"};
+    for (int s = 0; s < 3; ++s) {
+        std::printf("static const char* const %s[POSITIONS_PER_SET] = {\n", sets[s]);
+        for (int i = 0; i < POSITIONS_PER_SET; ++i) {
+            std::printf("    \"%s\",\n", positions[s * POSITIONS_PER_SET + i].moves.c_str());
+        }
+        std::printf("};\n");
+    }
+}
+
+std::vector<Position> makePositions() {
+    const char* const names[] = {"opening", "midgame", "tactical"};
+    const char* const* const sets[] = {OPENING_SET, MIDGAME_SET, TACTICAL_SET};
+    std::vector<Position> out;
+    for (int s = 0; s < 3; ++s) {
+        for (int i = 0; i < POSITIONS_PER_SET; ++i) {
+            Position p;
+            p.name  = std::string(names[s]) + "-" + std::to_string(i);
+            p.moves = sets[s][i];
+            if (!parseMoveList(p.moves, p.board)) {
+                std::fprintf(stderr, "bad bench position %s\n", p.name.c_str());
+                std::exit(1);
+            }
+            out.push_back(p);
+        }
+    }
+    return out;
+}
+
+void report(const char* name, double ns, std::uint64_t ops) {
+    const double nsPerOp = ns / static_cast<double>(ops);
+    std::printf("%-32s %12.1f ns/op %14.0f ops/s\n", name, nsPerOp, 1e9 / nsPerOp);
+}
+
+// Run 'op' (which performs 'opsPerCall' operations) until minMs have
+// passed and print ns/op and ops/sec.
+void measure(const char* name, int minMs, std::uint64_t opsPerCall,
+             const std::function<void()>& op) {
+    op();  // warm-up
+    std::uint64_t ops = 0;
+    const Clock::time_point start = Clock::now();
+    double ns = 0.0;
+    do {
+        for (int i = 0; i < 16; ++i) op();
+        ops += 16 * opsPerCall;
+        ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    } while (ns < minMs * 1e6);
+    report(name, ns, ops);
+}
+
+void benchBoard(std::vector<Position>& positions, int minMs) {
+    const std::uint64_t n = positions.size();
+
+    std::vector<MoveList> candidates(positions.size());
+    std::uint64_t moveOps = 0;
+    for (std::size_t i = 0; i < positions.size(); ++i) {
+        positions[i].board.getCandidateMoves(candidates[i]);
+        moveOps += candidates[i].size();
+    }
+    measure("Board::makeMove+unmakeMove", minMs, moveOps, [&]() {
+        for (std::size_t i = 0; i < positions.size(); ++i) {
+            Board& b = positions[i].board;
+            for (const Move& m : candidates[i]) {
+                b.makeMove(m.x, m.y);
+                b.unmakeMove(m.x, m.y);
+            }
+            g_sink = g_sink + b.getHashKey();
+        }
+    });
+
+    measure("Board::checkWin", minMs, 2 * n, [&]() {
+        for (const Position& p : positions) {
+            g_sink = g_sink + p.board.checkWin(Player::Black) + p.board.checkWin(Player::White);
+        }
+    });
+
+    measure("Board::isWinningMove", minMs, moveOps, [&]() {
+        for (std::size_t i = 0; i < positions.size(); ++i) {
+            const Board& b = positions[i].board;
+            for (const Move& m : candidates[i]) g_sink = g_sink + b.isWinningMove(m.x, m.y, b.sideToMove());
+        }
+    });
+
+    measure("Board::getCandidateMoves", minMs, n, [&]() {
+        MoveList out;
+        for (const Position& p : positions) {
+            p.board.getCandidateMoves(out);
+            g_sink = g_sink + out.size();
+        }
+    });
+
+    measure("Board::getCandidateMoves(r=2)", minMs, n, [&]() {
+        MoveList out;
+        for (const Position& p : positions) {
+            p.board.getCandidateMoves(out, 2);
+            g_sink = g_sink + out.size();
+        }
+    });
+
+    measure("Board::emptyCells", minMs, n, [&]() {
+        for (const Position& p : positions) {
+            for (const Move& m : p.board.emptyCells()) g_sink = g_sink + m.x;
+        }
+    });
+
+    measure("Board::snapshot+restore", minMs, n, [&]() {
+        Board scratch;
+        for (const Position& p : positions) {
+            scratch.restore(p.board.snapshot());
+            g_sink = g_sink + scratch.getHashKey();
+        }
+    });
+}
+
+void benchThreats(const std::vector<Position>& positions, int minMs) {
+    // Cold: every call is a cache miss.  Solvers are built outside the
+    // timed region, one per position and round.
+    {
+        const int rounds = 4;
+        std::uint64_t ops = 0;
+        double ns = 0.0;
+        for (int r = 0; r < rounds; ++r) {
+            for (const Position& p : positions) {
+                ThreatSolver solver(p.board);
+                const Clock::time_point start = Clock::now();
+                const ThreatAnalysis a = solver.analyzeThreats(p.board, p.board.sideToMove());
+                ns += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+                g_sink = g_sink + a.attackerHasForcedWin;
+                ++ops;
+            }
+        }
+        report("ThreatSolver::analyzeThreats", ns, ops);
+    }
+
+    std::vector<std::unique_ptr<ThreatSolver>> solvers;
+    for (const Position& p : positions) solvers.emplace_back(new ThreatSolver(p.board));
+
+    measure("ThreatSolver::analyzeThreats(warm)", minMs, positions.size(), [&]() {
+        for (std::size_t i = 0; i < positions.size(); ++i) {
+            const Board& b = positions[i].board;
+            g_sink = g_sink + solvers[i]->analyzeThreats(b, b.sideToMove()).attackerHasForcedWin;
+        }
+    });
+
+    measure("ThreatSolver::computeDefensiveSet", minMs, positions.size(), [&]() {
+        for (std::size_t i = 0; i < positions.size(); ++i) {
+            const Board& b = positions[i].board;
+            g_sink = g_sink + solvers[i]->computeDefensiveSet(b.sideToMove()).defensiveMoves.size();
+        }
+    });
+}
+
+void benchTT(int minMs) {
+    TranspositionTable tt(TranspositionTable::kDefaultSizeMB);
+    const std::size_t keyCount = std::size_t(1) << 16;
+    std::vector<std::uint64_t> keys(keyCount);
+    std::mt19937_64 rng(SEED);
+    for (std::uint64_t& k : keys) k = rng();
+
+    int depth = 0;
+    measure("TranspositionTable::store", minMs, keyCount, [&]() {
+        for (std::uint64_t k : keys) {
+            tt.store(k, static_cast<EvalScore>(k & 1023), 0, depth, TTNodeType::Exact,
+                     Move(static_cast<int>(k % 12), static_cast<int>((k >> 8) % 12)));
+        }
+        depth = (depth + 1) & 31;
+    });
+    measure("TranspositionTable::probe", minMs, keyCount, [&]() {
+        TTEntry e;
+        for (std::uint64_t k : keys) g_sink = g_sink + tt.probe(k, e);
+    });
+    measure("TranspositionTable::probe(miss)", minMs, keyCount, [&]() {
+        TTEntry e;
+        for (std::uint64_t k : keys) g_sink = g_sink + tt.probe(~k, e);
+    });
+}
+
+void benchEvaluator(std::vector<Position>& positions, int minMs) {
+    // Every call sees a different board, so each one rebuilds in full.
+    PatternEvaluator full;
+    measure("PatternEvaluator::evaluate(full)", minMs, positions.size(), [&]() {
+        for (const Position& p : positions) {
+            g_sink = g_sink + static_cast<std::uint64_t>(full.evaluate(p.board, p.board.sideToMove()));
+        }
+    });
+
+    std::vector<std::unique_ptr<PatternEvaluator>> evaluators;
+    std::vector<MoveList> candidates(positions.size());
+    std::uint64_t ops = 0;
+    for (std::size_t i = 0; i < positions.size(); ++i) {
+        evaluators.emplace_back(new PatternEvaluator(positions[i].board));
+        positions[i].board.getCandidateMoves(candidates[i]);
+        ops += candidates[i].size();
+    }
+    measure("PatternEvaluator::evaluate(incr)", minMs, ops, [&]() {
+        for (std::size_t i = 0; i < positions.size(); ++i) {
+            Board& b = positions[i].board;
+            PatternEvaluator& ev = *evaluators[i];
+            const Player side = b.sideToMove();
+            for (const Move& m : candidates[i]) {
+                b.makeMove(m.x, m.y);
+                ev.notifyMove(m);
+                g_sink = g_sink + static_cast<std::uint64_t>(ev.evaluate(b, side));
+                b.unmakeMove(m.x, m.y);
+                ev.notifyUndo(m);
+            }
+        }
+    });
+}
+
+void benchSearch(const std::vector<Position>& positions, int depth) {
+    std::printf("\nbench search, depth %d\n", depth);
+    std::uint64_t total = 0;
+    double totalMs = 0.0;
+    for (const Position& pos : positions) {
+        Board board = pos.board;
+        PatternEvaluator evaluator(board);
+        ThreatSolver threats(board);
+        HistoryHeuristic history;
+        SearchEngine engine(board, evaluator, &threats, &history);
+
+        SearchLimits limits;
+        limits.maxDepth    = depth;
+        limits.timeLimitMs = 0;
+        limits.enablePanicMode = false;
+        const Clock::time_point start = Clock::now();
+        const SearchResult r = engine.searchBestMove(limits);
+        const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        const std::uint64_t nodes = r.nodes + r.qnodes;
+        total   += nodes;
+        totalMs += ms;
+        std::printf("%-12s move (%2d,%2d) score %7d depth %2d nodes %10llu %9.1f ms\n",
+                    pos.name.c_str(), r.bestMove.x, r.bestMove.y, r.bestScore,
+                    r.depthReached, static_cast<unsigned long long>(nodes), ms);
+    }
+    std::printf("\nTotal nodes: %llu\n", static_cast<unsigned long long>(total));
+    std::printf("Time: %.0f ms\n", totalMs);
+    std::printf("Nodes/second: %.0f\n", totalMs > 0.0 ? total * 1000.0 / totalMs : 0.0);
+}
+
+} // unnamed namespace
+
+int main(int argc, char** argv) {
+    if (argc > 1 && std::string(argv[1]) == "--make-positions") {
+        printPositions(generatePositions());
+        return 0;
+    }
+    const int depth = argc > 1 ? std::atoi(argv[1]) : 4;
+    const int minMs = argc > 2 ? std::atoi(argv[2]) : 200;
+
+    std::vector<Position> positions = makePositions();
+    std::printf("%zu positions (%d opening, %d midgame, %d tactical)\n\n",
+                positions.size(), POSITIONS_PER_SET, POSITIONS_PER_SET, POSITIONS_PER_SET);
+
+    benchBoard(positions, minMs);
+    benchThreats(positions, minMs);
+    benchTT(minMs);
+    benchEvaluator(positions, minMs);
+    benchSearch(positions, depth);
+    return 0;
+}
@@ -0,0 +1,114 @@
+#ifndef GOMOKU_ANALYSIS_SERVICE_H
+#define GOMOKU_ANALYSIS_SERVICE_H
+
+#include "core/board.h"
+#include "search/search_types.h"
+#include "search/transposition_table.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gomoku {
+
+// One position to analyse.
+struct AnalysisJob {
+    std::uint64_t id = 0;   // caller's tag, echoed in the result
+    Board         board;
+    SearchLimits  limits;   // ttSizeMB is ignored: workers keep their table
+};
+
+struct AnalysisResult {
+    std::uint64_t id = 0;
+    std::size_t   index = 0;  // position in submission order, from 0
+    SearchResult  result;
+};
+
+// Batch analysis of independent positions over a pool of workers.
+//
+// Each worker owns one long-lived engine: a Board, a PatternEvaluator, a
+// ThreatSolver, a HistoryHeuristic and a SearchEngine with its
+// transposition table, all built once.  For a job the worker copies the
+// position into its board, re-syncs the threat solver, clears the history
+// (the positions are unrelated) and searches with the job's limits.  The
+// table is only aged between jobs, so positions from the same game (or
+// transpositions of each other) reuse earlier results.
+//
+// Results are delivered to the callback in submission order, from a
+// worker thread, one at a time.  submit() blocks while 'maxBacklog' jobs
+// are queued, running or waiting for an earlier result, so a producer that
+// streams a large corpus keeps memory bounded.
+//
+// Thread safety: submit() and finish() may be called from one producer
+// thread.  The callback must not call back into the service.
+class AnalysisService {
+public:
+    using ResultCallback = std::function<void(const AnalysisResult&)>;
+
+    // 'workers' threads (at least one), each with a 'ttSizeMB' table.
+    // 'maxBacklog' of 0 means four jobs per worker.
+    AnalysisService(int                workers,
+                    ResultCallback     onResult,
+                    std::size_t        ttSizeMB = TranspositionTable::kDefaultSizeMB,
+                    std::size_t        maxBacklog = 0);
+    ~AnalysisService();  // finish()
+
+    AnalysisService(const AnalysisService&) = delete;
+    AnalysisService& operator=(const AnalysisService&) = delete;
+
+    // Queue a position.  Returns its index.
+    std::size_t submit(AnalysisJob job);
+
+    // Wait until every submitted job has been reported.  The service can
+    // take more jobs afterwards.
+    void finish();
+
+    int workerCount() const { return static_cast<int>(workers_.size()); }
+
+    // Analyse 'jobs' on a temporary pool and return the results in order.
+    static std::vector<AnalysisResult> analyzeAll(const std::vector<AnalysisJob>& jobs,
+                                                  int workers,
+                                                  std::size_t ttSizeMB = TranspositionTable::kDefaultSizeMB);
+
+private:
+    struct Worker;
+    struct Pending {
+        std::size_t index;
+        AnalysisJob job;
+    };
+
+    void workerLoop(Worker& worker);
+    // Hand a finished result over and deliver every result that is next
+    // in order.
+    void complete(AnalysisResult result);
+
+    ResultCallback onResult_;
+    std::size_t    maxBacklog_;
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+
+    std::mutex              mutex_;
+    std::condition_variable jobReady_;   // queue not empty, or shutting down
+    std::condition_variable progress_;   // a result was delivered
+    std::deque<Pending>     queue_;
+    bool                    shutdown_ = false;
+    std::size_t             submitted_ = 0;
+    std::size_t             delivered_ = 0;
+
+    // Results waiting for an earlier index; delivery is serialised by
+    // deliverMutex_ so the callback sees one result at a time, in order.
+    std::mutex                            deliverMutex_;
+    std::map<std::size_t, AnalysisResult> finished_;
+    std::size_t                           nextToDeliver_ = 0;
+};
+
+} // namespace gomoku
+
+#endif // GOMOKU_ANALYSIS_SERVICE_H
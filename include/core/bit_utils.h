@@ -0,0 +1,78 @@
+// bit_utils.h
+// Bit-scan helpers for the 64-bit bitboard chunks.
+//
+// Uses <bit> (std::popcount / std::countr_zero) when the standard library
+// provides it, compiler intrinsics otherwise, and a portable fallback as a
+// last resort, so every caller gets hardware popcnt/tzcnt where available.
+
+#ifndef GOMOKU_BIT_UTILS_H
+#define GOMOKU_BIT_UTILS_H
+
+#include <cstdint>
+
+#if defined(__has_include)
+#  if __has_include(<bit>) && __cplusplus >= 202002L
+#    include <bit>
+#  endif
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#  include <intrin.h>
+#endif
+
+namespace gomoku {
+
+// Number of set bits in v.
+inline int popcount64(uint64_t v) {
+#if defined(__cpp_lib_bitops)
+    return std::popcount(v);
+#elif defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(v);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    return static_cast<int>(__popcnt64(v));
+#else
+    int n = 0;
+    while (v) {
+        v &= v - 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+// Index of the lowest set bit of v.  v must be non-zero.
+inline int countTrailingZeros64(uint64_t v) {
+#if defined(__cpp_lib_bitops)
+    return std::countr_zero(v);
+#elif defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(v);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long idx;
+    _BitScanForward64(&idx, v);
+    return static_cast<int>(idx);
+#else
+    // de Bruijn multiply on the isolated lowest bit.
+    static const int kIndex[64] = {
+         0,  1, 48,  2, 57, 49, 28,  3, 61, 58, 50, 42, 38, 29, 17,  4,
+        62, 55, 59, 36, 53, 51, 43, 22, 45, 39, 33, 30, 24, 18, 12,  5,
+        63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11,
+        46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19,  9, 13,  8,  7,  6
+    };
+    return kIndex[((v & (~v + 1)) * 0x03F79D71B4CB0A89ULL) >> 58];
+#endif
+}
+
+// Call fn(index) for every set bit of a 144-bit bitboard stored as three
+// 64-bit chunks (index = chunk * 64 + bit, i.e. y * 12 + x), lowest first.
+template <typename Fn>
+inline void forEachSetBit(const uint64_t chunks[3], Fn fn) {
+    for (int c = 0; c < 3; ++c) {
+        for (uint64_t bits = chunks[c]; bits; bits &= bits - 1) {
+            fn(c * 64 + countTrailingZeros64(bits));
+        }
+    }
+}
+
+} // namespace gomoku
+
+#endif // GOMOKU_BIT_UTILS_H
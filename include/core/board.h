@@ -5,8 +5,12 @@
 #define GOMOKU_BOARD_H
 
 #include <cstdint>
+#include <type_traits>
 #include <vector>
 
+#include "bit_utils.h"
+#include "inline_vector.h"
+
 namespace gomoku {
 
 // Representation of the two possible players.
@@ -32,6 +36,80 @@ struct Move {
     }
 };
 
+// Fixed-capacity move buffer large enough for every cell of the board;
+// move generators fill one supplied by the caller instead of allocating.
+using MoveList = InlineVector<Move, 144>;
+
+// Compact, trivially copyable position: the stone bitboards, the side to
+// move and the Zobrist key in 56 bytes, for Board::snapshot()/restore()
+// and for storing positions in bulk.
+//
+// stones[p] holds cell y * 12 + x at bit (index & 63) of chunk index / 64,
+// as Board's own bitboards do.  Cells stop at bit 15 of chunk 2, so the
+// side to move is kept in the otherwise unused kSideBit of stones[1][2]
+// (set = White); use sideToMove() rather than reading it directly.
+struct BoardState {
+    static constexpr uint64_t kSideBit = 1ULL << 63;
+
+    uint64_t stones[2][3];
+    uint64_t hash;  // Board::getHashKey()
+
+    Player sideToMove() const {
+        return (stones[1][2] & kSideBit) ? Player::White : Player::Black;
+    }
+};
+static_assert(sizeof(BoardState) == 56, "BoardState is 56 bytes");
+static_assert(std::is_trivially_copyable<BoardState>::value, "BoardState must be a POD");
+
+// Range over the empty cells of a position, lowest index (row-major) first:
+//
+//   for (const Move& m : board.emptyCells()) ...
+//
+// It iterates a copy of the empty-cell bitboard taken when the range was
+// made, so the board may be changed inside the loop (e.g. a stone placed
+// and removed again) without disturbing the iteration.  No allocation.
+class EmptyCells {
+public:
+    class iterator {
+    public:
+        Move operator*() const {
+            const int idx = chunk_ * 64 + countTrailingZeros64(bits_[chunk_]);
+            return Move(idx % 12, idx / 12);
+        }
+        iterator& operator++() {
+            bits_[chunk_] &= bits_[chunk_] - 1;
+            skipEmptyChunks();
+            return *this;
+        }
+        bool operator==(const iterator& other) const {
+            return chunk_ == other.chunk_ && (chunk_ == 3 || bits_[chunk_] == other.bits_[chunk_]);
+        }
+        bool operator!=(const iterator& other) const { return !(*this == other); }
+
+    private:
+        friend class EmptyCells;
+        iterator(const uint64_t bits[3], int chunk) : bits_{bits[0], bits[1], bits[2]}, chunk_(chunk) {
+            skipEmptyChunks();
+        }
+        void skipEmptyChunks() {
+            while (chunk_ < 3 && bits_[chunk_] == 0) ++chunk_;
+        }
+
+        uint64_t bits_[3];
+        int      chunk_;
+    };
+
+    explicit EmptyCells(const uint64_t empty[3]) : bits_{empty[0], empty[1], empty[2]} {}
+
+    iterator begin() const { return iterator(bits_, 0); }
+    iterator end() const   { return iterator(bits_, 3); }
+
+    int size() const { return popcount64(bits_[0]) + popcount64(bits_[1]) + popcount64(bits_[2]); }
+
+private:
+    uint64_t bits_[3];
+};
+
 // Represents a 12×12 Gomoku board using bitboards.
 class Board {
 public:
@@ -55,20 +133,72 @@ public:
     // returns true.
     bool unmakeMove(int x, int y);
 
+    // Pass the turn without placing a stone (null-move pruning).  Only the
+    // side to move and its hash marker change; undo with unmakeNullMove().
+    void makeNullMove();
+    void unmakeNullMove();
+
     // Check whether the specified player currently has five in a row.
+    // Scans the whole board with shift-and-AND on the bitboards; prefer
+    // checkWinAt() when the last move is known.
     bool checkWin(Player player) const;
 
+    // Check whether the stone at (x,y) is part of five in a row for the
+    // player who owns it.  Only the four lines through (x,y) are inspected,
+    // so this is the cheap test to run right after makeMove(x,y).  Returns
+    // false if (x,y) is empty or off the board.
+    bool checkWinAt(int x, int y) const;
+
+    // Return true if placing a stone of 'player' on the empty cell (x,y)
+    // would complete five in a row.  The board is not modified, so callers
+    // do not need a makeMove/checkWin/unmakeMove round trip.
+    bool isWinningMove(int x, int y, Player player) const;
+
     // Get a list of legal (empty) positions on the board.
     std::vector<Move> getLegalMoves() const;
 
-    // Generate candidate moves within a bounding box around existing stones.
-    // This function is intended for use by the search engine.  It limits
-    // move generation to locations close to the action (within a margin of
-    // two cells of any existing stone) and ignores cells that have no
-    // neighboring stones.  If the board is empty (no stones), it will
+    // The empty cells, read straight from the bitboards (no allocation);
+    // prefer this to getLegalMoves() on hot paths.
+    EmptyCells emptyCells() const;
+
+    // --- Snapshots ---
+    // snapshot() captures the position in a 56-byte BoardState.  restore()
+    // moves the board to a snapshot's position by removing and placing only
+    // the stones that differ, keeping every derived structure (line
+    // bitboards, neighbour counts, the eight hash keys) up to date.  It
+    // returns false and leaves the board unchanged if the state is
+    // malformed (a cell of both colours, stone bits off the board); debug
+    // builds also check that state.hash matches the stones.
+    //
+    // Restoring costs about as much as playing the differing stones, so
+    // it is quick between nearby positions but slower than copying a
+    // Board for an unrelated one.  Snapshots are the compact way to keep
+    // many positions around or to send them elsewhere.
+    BoardState snapshot() const;
+    bool restore(const BoardState& state);
+
+    // The Zobrist key (getHashKey()) of the position in 'state', which
+    // need not be valid; state.hash itself is ignored.  For filling in a
+    // BoardState built from another format.
+    static uint64_t hashOf(const BoardState& state);
+
+    // Generate candidate moves next to existing stones.  This function is
+    // intended for use by the search engine.  It limits move generation to
+    // empty cells with at least one neighbouring stone (8-neighbourhood),
+    // in row-major order.  If the board is empty (no stones), it will
     // return the central location (5,5) as the only candidate.
     std::vector<Move> getCandidateMoves() const;
 
+    // Same, written into a caller-owned buffer (no allocation); the search
+    // hot path should use this overload.  'radius' is the king distance to
+    // the nearest stone (1 = adjacent cells, 2 = within two cells).  The
+    // radius-1 set is kept incrementally by every mutator, so the default
+    // costs one AND with the empty cells; larger radii dilate it further.
+    void getCandidateMoves(MoveList& out, int radius = 1) const;
+
+    // Number of stones (either colour) in the 8-neighbourhood of (x,y).
+    int neighbourStoneCount(int x, int y) const { return neighbourCount[index(x, y)]; }
+
     // Return a code describing the occupant of the cell at (x,y):
     // 0 = empty, 1 = black, 2 = white.  This helper is mainly for
     // evaluation purposes.
@@ -77,13 +207,67 @@ public:
     // Utility to count how many stones a player has on the board.
     int countStones(Player player) const;
 
+    // --- Per-direction line bitboards ---
+    // Besides the row-major bitboards, every line of the board is stored as
+    // a packed integer per player and direction: bit i is the i-th cell
+    // along the line.  They are kept up to date by every public mutator, so
+    // any line can be read in O(1).
+    //
+    // Direction indices follow tactics' Direction enum:
+    //   0 = horizontal     lineId = y,          offset = x
+    //   1 = vertical       lineId = x,          offset = y
+    //   2 = NW-SE (\)      lineId = x - y + 11, offset = min(x, y)
+    //   3 = NE-SW (/)      lineId = x + y,      offset = x - max(0, x + y - 11)
+    // Diagonal lines have length 12 - |lineId - 11|.
+    static constexpr int kNumDirections = 4;
+    static constexpr int kMaxLinesPerDirection = 23;
+
+    static int lineCount(int dir) { return dir < 2 ? 12 : 23; }
+    static int lineIdOf(int dir, int x, int y);
+    static int lineOffsetOf(int dir, int x, int y);
+    static int lineLength(int dir, int lineId);
+    // Board coordinate of the cell at 'offset' along line 'lineId'.
+    static Move lineCell(int dir, int lineId, int offset);
+
+    // Stones of 'player' along line 'lineId' in direction 'dir' (low
+    // lineLength(dir, lineId) bits are meaningful).
+    uint16_t getLine(Player player, int dir, int lineId) const {
+        return lines[static_cast<int>(player)][dir][lineId];
+    }
+
+    // Stones of 'player' along the line through (x,y) in direction 'dir'.
+    uint16_t getLineThrough(Player player, int dir, int x, int y) const {
+        return getLine(player, dir, lineIdOf(dir, x, y));
+    }
+
     // Return the Zobrist hash key for the current position.  This value
     // uniquely represents the state of the board (including side to move) and
     // can be used by transposition tables.  It is updated incrementally as
     // moves are made and undone, and remains consistent after any public
     // mutator that changes the board contents or side to move
     // (makeMove, unmakeMove, placeStone, removeStone, setSideToMove).
-    uint64_t getHashKey() const { return hashKey; }
+    uint64_t getHashKey() const { return hashKeys[0]; }
+
+    // --- Symmetry ---
+    // The 8 dihedral transforms of the board.  Transform s maps (x,y) by
+    // first swapping x and y if s & 4, then mirroring x if s & 1 and y if
+    // s & 2; transform 0 is the identity.  The opening cross is invariant
+    // under 0, 3 (half turn), 4 (main diagonal) and 7 (anti-diagonal), so
+    // those are exact symmetries of the starting position.
+    static constexpr int kNumSymmetries = 8;
+
+    static Move transformMove(int symmetry, const Move& m);
+    static Move inverseTransformMove(int symmetry, const Move& m);
+
+    // Hash key of the position transformed by 'symmetry' (same side to
+    // move).  All eight are kept incrementally next to the plain key.
+    uint64_t getSymmetryKey(int symmetry) const { return hashKeys[symmetry]; }
+
+    // Smallest of the eight symmetry keys: equal for every orientation of
+    // the same position.  If 'symmetry' is given it receives the transform
+    // whose key was chosen, so a move m of this position is stored as
+    // transformMove(*symmetry, m) and read back with inverseTransformMove().
+    uint64_t getCanonicalKey(int* symmetry = nullptr) const;
 
     //Helper functions:
     Player getSideToMove() const;//Inspect current side (legacy alias; prefer sideToMove() in new code)
@@ -99,9 +283,35 @@ private:
     static inline int chunkOf(int idx) { return idx >> 6; }
     static inline int offsetOf(int idx) { return idx & 63; }
 
+    // Flip the bit of (x,y) in all four line bitboards of player p.  Called
+    // by every mutator next to the bb[] update.
+    void toggleLineBits(int p, int x, int y);
+
+    // Stones of player p on the line through (x,y) in direction dir, at
+    // distance at most 4.  Bit 4 of the result is (x,y) itself.
+    uint32_t lineWindow(int p, int dir, int x, int y) const;
+
+    // XOR the stone of player p at (x,y), or the side-to-move marker, into
+    // all eight hash keys.
+    void toggleStoneHash(int p, int x, int y);
+    void toggleSideHash();
+
+    // Add 'delta' (+1 / -1) to the neighbour count of the 8 cells around
+    // (x,y) and update nearStones.  Called by every mutator next to
+    // toggleLineBits(); counts make undo exact.
+    void adjustNeighbours(int x, int y, int delta);
+
     // Bitboards for black and white. bb[player][chunk] holds bits for that player.
     uint64_t bb[2][3];
 
+    // Line bitboards: lines[player][dir][lineId], see getLine().
+    uint16_t lines[2][kNumDirections][kMaxLinesPerDirection];
+
+    // neighbourCount[idx] = stones in the 8-neighbourhood of cell idx;
+    // nearStones has a bit for every cell whose count is non-zero.
+    uint8_t  neighbourCount[144];
+    uint64_t nearStones[3];
+
     // The player who will make the next move.
     Player side_to_move;
 
@@ -111,18 +321,76 @@ private:
     static bool zobristInitialized;
     static uint64_t zobristTable[12][12][2];
     static uint64_t zobristSide;
+    // symmetryZobrist[s][p][idx]: zobristTable entry of cell idx after
+    // transform s, so each symmetry key costs one lookup per stone.
+    static uint64_t symmetryZobrist[kNumSymmetries][2][144];
 
-    // The current position's Zobrist hash key.  It is maintained
-    // incrementally and remains consistent after all public mutators that
-    // change the board contents or side to move (makeMove, unmakeMove,
-    // placeStone, removeStone, setSideToMove).
-    uint64_t hashKey;
+    // The current position's Zobrist hash key ([0]) and the keys of its
+    // seven transforms.  They are maintained incrementally and remain
+    // consistent after all public mutators that change the board contents
+    // or side to move (makeMove, unmakeMove, placeStone, removeStone,
+    // setSideToMove).
+    uint64_t hashKeys[kNumSymmetries];
 
     // Initialize Zobrist tables with random numbers.  Called lazily by the
     // constructor to ensure proper seeding.
     static void initZobrist();
 };
 
+inline Move Board::transformMove(int symmetry, const Move& m) {
+    int x = m.x;
+    int y = m.y;
+    if (symmetry & 4) {
+        x = m.y;
+        y = m.x;
+    }
+    if (symmetry & 1) x = 11 - x;
+    if (symmetry & 2) y = 11 - y;
+    return Move(x, y);
+}
+
+inline Move Board::inverseTransformMove(int symmetry, const Move& m) {
+    const int x = (symmetry & 1) ? 11 - m.x : m.x;
+    const int y = (symmetry & 2) ? 11 - m.y : m.y;
+    return (symmetry & 4) ? Move(y, x) : Move(x, y);
+}
+
+inline int Board::lineIdOf(int dir, int x, int y) {
+    switch (dir) {
+        case 0:  return y;
+        case 1:  return x;
+        case 2:  return x - y + 11;
+        default: return x + y;
+    }
+}
+
+inline int Board::lineOffsetOf(int dir, int x, int y) {
+    switch (dir) {
+        case 0:  return x;
+        case 1:  return y;
+        case 2:  return x < y ? x : y;
+        default: return (x + y > 11) ? 11 - y : x;
+    }
+}
+
+inline int Board::lineLength(int dir, int lineId) {
+    if (dir < 2) return 12;
+    return lineId <= 11 ? lineId + 1 : 23 - lineId;
+}
+
+inline Move Board::lineCell(int dir, int lineId, int offset) {
+    switch (dir) {
+        case 0:  return Move(offset, lineId);
+        case 1:  return Move(lineId, offset);
+        case 2:  return (lineId >= 11) ? Move(lineId - 11 + offset, offset)
+                                       : Move(offset, 11 - lineId + offset);
+        default: {
+            int x0 = (lineId > 11) ? lineId - 11 : 0;
+            return Move(x0 + offset, lineId - x0 - offset);
+        }
+    }
+}
+
 } // namespace gomoku
 
 #endif // GOMOKU_BOARD_H
\ No newline at end of file
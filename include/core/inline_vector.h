@@ -0,0 +1,82 @@
+// inline_vector.h
+// Fixed-capacity vector with inline storage (no heap allocation).
+
+#ifndef GOMOKU_INLINE_VECTOR_H
+#define GOMOKU_INLINE_VECTOR_H
+
+#include <cassert>
+#include <cstddef>
+
+namespace gomoku {
+
+// A std::vector look-alike for small, bounded collections on hot paths
+// (threat instances, move lists).  Elements live inside the object, so
+// copying one copies all N slots; size the capacity to the real bound.
+//
+// Pushing beyond capacity is a logic error: it asserts in debug builds and
+// drops the element in release builds.  Callers that cannot bound their
+// input must check full() first.
+template <typename T, std::size_t N>
+class InlineVector {
+public:
+    using value_type     = T;
+    using size_type      = std::size_t;
+    using iterator       = T*;
+    using const_iterator = const T*;
+
+    InlineVector() = default;
+
+    static constexpr size_type capacity() { return N; }
+
+    size_type size() const  { return size_; }
+    bool      empty() const { return size_ == 0; }
+    bool      full() const  { return size_ == N; }
+
+    void clear() { size_ = 0; }
+
+    // Returns false (and drops v) if the vector is full.
+    bool push_back(const T& v) {
+        assert(size_ < N && "InlineVector capacity exceeded");
+        if (size_ >= N) return false;
+        data_[size_++] = v;
+        return true;
+    }
+
+    void pop_back() {
+        assert(size_ > 0);
+        --size_;
+    }
+
+    // Appends [first, last) at the end; 'pos' must be end().  Elements that
+    // do not fit are dropped (see push_back).
+    template <typename It>
+    void insert(const_iterator pos, It first, It last) {
+        assert(pos == end());
+        (void)pos;
+        for (; first != last; ++first) push_back(*first);
+    }
+
+    T&       operator[](size_type i)       { return data_[i]; }
+    const T& operator[](size_type i) const { return data_[i]; }
+
+    T&       front()       { return data_[0]; }
+    const T& front() const { return data_[0]; }
+    T&       back()        { return data_[size_ - 1]; }
+    const T& back() const  { return data_[size_ - 1]; }
+
+    T*       data()       { return data_; }
+    const T* data() const { return data_; }
+
+    iterator       begin()       { return data_; }
+    const_iterator begin() const { return data_; }
+    iterator       end()         { return data_ + size_; }
+    const_iterator end() const   { return data_ + size_; }
+
+private:
+    T         data_[N];
+    size_type size_ = 0;
+};
+
+} // namespace gomoku
+
+#endif // GOMOKU_INLINE_VECTOR_H
@@ -0,0 +1,43 @@
+// position_codec.h
+// Compact serialisations of a Board position, for position corpora and
+// analysis pipelines.
+
+#ifndef GOMOKU_POSITION_CODEC_H
+#define GOMOKU_POSITION_CODEC_H
+
+#include <cstddef>
+#include <string>
+
+#include "board.h"
+
+namespace gomoku {
+
+// Packed position: 37 bytes.
+//
+//   bytes  0..17 : black stones, bit i (byte i / 8, bit i % 8) = cell i
+//   bytes 18..35 : white stones, same layout
+//   byte  36     : side to move (0 = black, 1 = white)
+//
+// Cell i is (i % 12, i / 12), the row-major index of Board's bitboards,
+// so the two 18-byte halves are the 144 cell bits of BoardState::stones[p]
+// in little-endian byte order: the portable form of a Board::snapshot().
+constexpr std::size_t kPackedPositionSize = 37;
+
+void packPosition(const Board& board, unsigned char out[kPackedPositionSize]);
+
+// Rebuild 'out' from a packed position.  Returns false (leaving 'out'
+// unchanged) if a cell holds both colours or the side byte is not 0/1.
+bool unpackPosition(const unsigned char* in, Board& out);
+
+// Move-list position: the moves played after the opening cross, as cells
+// separated by spaces or commas.  A cell is a column letter a-l (x) and a
+// row number 1-12 (y + 1), e.g. "e5 h8 e4"; the colours alternate from
+// Black.  Returns false on a malformed cell or an occupied square.
+bool parseMoveList(const std::string& text, Board& out);
+
+// "e5" for Move(4, 4).
+std::string cellName(const Move& move);
+
+} // namespace gomoku
+
+#endif // GOMOKU_POSITION_CODEC_H
@@ -1,6 +1,8 @@
 #ifndef GOMOKU_SEARCH_EVALUATOR_H
 #define GOMOKU_SEARCH_EVALUATOR_H
 
+#include <cstdint>
+#include <memory>
 #include "core/board.h"
 #include "search/search_types.h"
 
@@ -16,8 +18,82 @@ public:
     //   * Side-aware: score is always from the perspective of "maximizing" side.
     //   * maxPlayer: The player for whom positive scores are favorable.
     virtual EvalScore evaluate(const Board& board, Player maxPlayer) = 0;
+
+    // Incremental hooks, called by SearchEngine (through MoveGuard) with the
+    // same protocol as IThreatSolver: syncFromBoard() when a search starts,
+    // notifyMove() right after Board::makeMove(), notifyUndo() right after
+    // Board::unmakeMove().  Stateless evaluators ignore them.
+    virtual void syncFromBoard(const Board& board) { (void)board; }
+    virtual void notifyMove(const Move& move) { (void)move; }
+    virtual void notifyUndo(const Move& move) { (void)move; }
+
+    // Independent copy for another search thread.  Returns nullptr if the
+    // evaluator cannot be copied; SearchEngine then searches single-threaded.
+    virtual std::unique_ptr<IEvaluator> clone() const { return nullptr; }
+};
+
+// Pattern evaluator built on the PatternTable threat shapes.
+//
+// Every line of the board (rows, columns, both diagonals) contributes, per
+// player, the weighted sum of the threats found in it: the line is split
+// into sub-lines by the opponent's stones and each sub-line is scored by one
+// table lookup (precomputed from PatternTable::candidatePatterns for every
+// sub-line length and stone mask).  Line contributions and their per-player
+// totals are kept up to date by notifyMove()/notifyUndo(), which re-score
+// only the four lines through the move, so evaluate() is O(1).
+//
+// On top of the line sum: a tempo bonus for the side to move and a bonus
+// for a player holding two or more forcing threats (four-three, three-three
+// shapes).  The result is clamped to ±kMaxEval, well inside the range the
+// transposition table stores exactly.
+//
+// If evaluate() is given a board it is not synchronised with (another Board
+// object, or a stone count that differs), it rebuilds from that board
+// first.  Changes that keep the stone count must be notified.
+class PatternEvaluator : public IEvaluator {
+public:
+    static constexpr EvalScore kMaxEval           = 20000;
+    static constexpr EvalScore kTempoBonus        = 20;
+    static constexpr EvalScore kDoubleThreatBonus = 800;
+
+    PatternEvaluator() = default;
+    explicit PatternEvaluator(const Board& board) { syncFromBoard(board); }
+
+    EvalScore evaluate(const Board& board, Player maxPlayer) override;
+
+    void syncFromBoard(const Board& board) override;
+    void notifyMove(const Move& move) override;
+    void notifyUndo(const Move& move) override;
+
+    // The copy stays bound to the same Board until its next syncFromBoard().
+    std::unique_ptr<IEvaluator> clone() const override;
+
+private:
+    static constexpr int kLines = Board::kMaxLinesPerDirection;
+
+    struct LineScore {
+        EvalScore    score[2]   = {0, 0};  // per player
+        std::uint8_t forcing[2] = {0, 0};  // forcing threats per player
+    };
+
+    // Saved contributions of the four lines through one move.
+    struct UndoRecord {
+        std::uint8_t cell = 0;
+        LineScore    lines[Board::kNumDirections];
+    };
+
+    LineScore scoreLine(const Board& board, int dir, int lineId) const;
+    void      setLine(int dir, int lineId, const LineScore& s);
+    void      rescoreLinesThrough(const Move& move);
+
+    const Board* board_ = nullptr;
+    int          stones_ = 0;
+    EvalScore    total_[2] = {0, 0};
+    int          forcing_[2] = {0, 0};
+    LineScore    lines_[Board::kNumDirections][kLines];
+    InlineVector<UndoRecord, 144> undo_;
 };
 
 } // namespace gomoku
 
-#endif // GOMOKU_SEARCH_EVALUATOR_H
\ No newline at end of file
+#endif // GOMOKU_SEARCH_EVALUATOR_H
@@ -1,10 +1,21 @@
 #ifndef GOMOKU_SEARCH_HISTORY_HEURISTIC_H
 #define GOMOKU_SEARCH_HISTORY_HEURISTIC_H
 
+#include <cstdint>
+#include <memory>
 #include "core/board.h"
 
 namespace gomoku {
 
+// Per-node move hints that depend on the path, not just the move: killer
+// moves of this ply and the countermove to the previous move.  Unused
+// slots are (-1,-1).
+struct OrderingHints {
+    static constexpr int kKillers = 2;
+    Move killers[kKillers] = {Move(-1, -1), Move(-1, -1)};
+    Move counterMove = Move(-1, -1);
+};
+
 // Interface for history heuristic and move ordering statistics.
 class IHistoryHeuristic {
 public:
@@ -21,8 +32,94 @@ public:
 
     // Utility: allow the search engine to clear history between games.
     virtual void clear() = 0;
+
+    // Called by the search engine at the start of every move: age the
+    // statistics (e.g. halve all scores) instead of clearing them, so what
+    // was learned on the previous move still orders moves, with less
+    // weight.  The default keeps the scores unchanged.
+    virtual void decay() {}
+
+    // --- Path-aware ordering (optional) ---
+    // 'ply' is the distance from the root; 'previousMove' is the move that
+    // led to the node ((-1,-1) at the root or after a null move).
+
+    // Same as recordBetaCutoff(), with the node's ply and previous move so
+    // killers and countermoves can be updated.
+    virtual void recordBetaCutoff(Player sideToMove, const Move& move, int depth,
+                                  int ply, const Move& previousMove) {
+        (void)ply;
+        (void)previousMove;
+        recordBetaCutoff(sideToMove, move, depth);
+    }
+
+    // A quiet move searched before the cutoff move of the same node.
+    virtual void recordFailedMove(Player sideToMove, const Move& move, int depth) {
+        (void)sideToMove;
+        (void)move;
+        (void)depth;
+    }
+
+    virtual void getOrderingHints(Player sideToMove, int ply, const Move& previousMove,
+                                  OrderingHints& out) const {
+        (void)sideToMove;
+        (void)ply;
+        (void)previousMove;
+        out = OrderingHints{};
+    }
+
+    // Independent copy for another search thread (each thread keeps its own
+    // statistics).  Returns nullptr if unsupported; that thread then orders
+    // moves without history.
+    virtual std::unique_ptr<IHistoryHeuristic> clone() const { return nullptr; }
+};
+
+// Default history heuristic.
+//
+//   * Butterfly history per side: score[side][cell].
+//   * Countermoves per side: the reply that last refuted a given previous
+//     move (of the opponent).
+//   * Two killer moves per ply.
+//
+// Updates use "gravity": score += bonus - score * |bonus| / kMaxScore, with
+// |bonus| <= kMaxScore, so every score stays within ±kMaxScore however long
+// the search runs, and frequently rewarded moves saturate instead of
+// overflowing.  A cutoff rewards the move with depth² and penalises the
+// quiet moves searched before it by the same amount.
+class HistoryHeuristic : public IHistoryHeuristic {
+public:
+    static constexpr int kMaxScore = 16384;
+    static constexpr int kMaxPly   = 64;
+
+    HistoryHeuristic();
+
+    int  getHistoryScore(Player sideToMove, const Move& move) const override;
+    void recordBetaCutoff(Player sideToMove, const Move& move, int depth) override;
+    void recordBetaCutoff(Player sideToMove, const Move& move, int depth,
+                          int ply, const Move& previousMove) override;
+    void recordFailedMove(Player sideToMove, const Move& move, int depth) override;
+    void recordPVMove(Player sideToMove, const Move& move, int depth) override;
+    void getOrderingHints(Player sideToMove, int ply, const Move& previousMove,
+                          OrderingHints& out) const override;
+
+    // Zero everything.
+    void clear() override;
+
+    // Halve the butterfly scores and forget the killers (their plies refer
+    // to the previous root).  Countermoves are kept.
+    void decay() override;
+
+    std::unique_ptr<IHistoryHeuristic> clone() const override;
+
+private:
+    static constexpr std::uint8_t kNoCell = 0xFF;
+
+    void update(int& entry, int bonus);
+
+    int          butterfly_[2][144];
+    std::uint8_t counterMove_[2][144];  // [side to move][previous move cell]
+    Move         killers_[kMaxPly][OrderingHints::kKillers];
 };
 
 } // namespace gomoku
 
-#endif // GOMOKU_SEARCH_HISTORY_HEURISTIC_H
\ No newline at end of file
+#endif // GOMOKU_SEARCH_HISTORY_HEURISTIC_H
@@ -0,0 +1,85 @@
+#ifndef GOMOKU_SEARCH_MOVE_SELECTOR_H
+#define GOMOKU_SEARCH_MOVE_SELECTOR_H
+
+#include <cstdint>
+#include "core/board.h"
+#include "search/history_heuristic.h"
+#include "tactics/Ithreat_solver.h"
+
+namespace gomoku {
+
+// Per-ply scratch space for move generation.  The engine keeps one per ply
+// so move lists never live on the heap.
+struct MoveBuffer {
+    MoveList moves;
+    int      scores[MoveList::capacity()];
+};
+
+// Staged move picker for one search node.
+//
+// Stages, in order:
+//   1. TT move (if legal).
+//   2. Threat moves: the side to move's winning move, then the moves that
+//      defend against the opponent's threats (ThreatAnalysis::defensiveMoves).
+//   3. Killer moves of this ply, then the countermove (OrderingHints), if
+//      they are candidate moves (next to a stone).
+//   4. Quiet moves: candidate moves, ordered by history score.
+//
+// Quiet moves are generated only when stage 4 is reached and are picked by
+// selection (best remaining first), so a cutoff on an early move never pays
+// for generating or sorting the rest.  A move is never returned twice.
+//
+// If restrictToDefenses is set, only defensive moves (and a TT move that is
+// one of them) are returned: the opponent has a winning threat and
+// everything else loses.
+class MovePicker {
+public:
+    MovePicker(const Board&              board,
+               Player                    sideToMove,
+               const Move*               ttMove,        // nullptr if none
+               const ThreatAnalysis*     ownThreats,    // side to move attacks; may be nullptr
+               const ThreatAnalysis*     oppThreats,    // opponent attacks; may be nullptr
+               bool                      restrictToDefenses,
+               const IHistoryHeuristic*  history,       // may be nullptr
+               const OrderingHints*      hints,         // may be nullptr
+               MoveBuffer&               buffer);
+
+    // Store the next move in 'out'; returns false when exhausted.
+    bool next(Move& out);
+
+    // Current stage (the stage the next move will come from).
+    enum class Stage : std::uint8_t { TTMove, Threats, Killers, GenerateQuiet, Quiet, Done };
+    Stage stage() const { return stage_; }
+
+    // True if the last move returned came from the killer or quiet stages
+    // (the moves history statistics are about).
+    bool lastWasQuiet() const {
+        return yieldedFrom_ == Stage::Killers || yieldedFrom_ == Stage::Quiet;
+    }
+
+private:
+    // Returns true (and marks m as returned) if m is legal and new.
+    bool tryYield(const Move& m, Move& out);
+    bool isDefense(const Move& m) const;
+
+    const Board&             board_;
+    Player                   side_;
+    const Move*              ttMove_;
+    const ThreatAnalysis*    own_;
+    const ThreatAnalysis*    opp_;
+    bool                     restrict_;
+    const IHistoryHeuristic* history_;
+    const OrderingHints*     hints_;
+    MoveBuffer&              buffer_;
+
+    Stage       stage_ = Stage::TTMove;
+    Stage       yieldedFrom_ = Stage::Done;
+    std::size_t threatIndex_ = 0;  // 0 = own winning move, i > 0 = defensiveMoves[i-1]
+    int         hintIndex_ = 0;    // killers, then the countermove
+    std::size_t quietIndex_ = 0;   // next unpicked slot in buffer_.moves
+    uint64_t    yielded_[3] = {0ULL, 0ULL, 0ULL};
+};
+
+} // namespace gomoku
+
+#endif // GOMOKU_SEARCH_MOVE_SELECTOR_H
@@ -0,0 +1,112 @@
+#ifndef GOMOKU_SEARCH_OPENING_BOOK_H
+#define GOMOKU_SEARCH_OPENING_BOOK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "core/board.h"
+
+namespace gomoku {
+
+// On-disk book record: one (position, move) pair.
+//
+//   key    : Board::getCanonicalKey() of the position
+//   cell   : move, y * 12 + x, in the canonical orientation
+//   score  : average search score of the move, from the perspective of the
+//            side to move at the position (clamped to int16)
+//   visits : how often the move was played from the position
+//
+// Records are 16 bytes, native (little-endian) byte order.
+struct BookRecord {
+    std::uint64_t key = 0;
+    std::uint8_t  cell = 0;
+    std::uint8_t  reserved = 0;
+    std::int16_t  score = 0;
+    std::uint32_t visits = 0;
+};
+static_assert(sizeof(BookRecord) == 16, "book records are 16 bytes");
+
+// A book move decoded for a particular board (orientation already undone).
+struct BookMove {
+    Move          move;
+    int           score = 0;
+    std::uint32_t visits = 0;
+};
+
+// Read-only opening book.
+//
+// File layout: a 32-byte header (magic "GMKBOOK1", version, record size,
+// record count) followed by the records sorted by (key, visits descending).
+// open() maps the file and checks the header; lookups binary-search the
+// mapped records in place, so opening a book of any size costs no parsing
+// and no copy.  Positions are looked up by canonical key, so the eight
+// orientations of a position share their records.
+//
+// On POSIX systems the file is mmap()ed; elsewhere it is read into memory.
+class OpeningBook {
+public:
+    OpeningBook() = default;
+    ~OpeningBook();
+
+    OpeningBook(const OpeningBook&) = delete;
+    OpeningBook& operator=(const OpeningBook&) = delete;
+
+    // Map 'path'.  Returns false (leaving the book closed) if the file is
+    // missing or not a book.
+    bool open(const std::string& path);
+    void close();
+
+    bool        isOpen() const { return records_ != nullptr; }
+    std::size_t size() const { return count_; }
+
+    // Moves stored for 'board', most visited first, at most 'maxMoves' of
+    // them written to 'out'.  Returns the number written.
+    std::size_t probe(const Board& board, BookMove* out, std::size_t maxMoves) const;
+
+    // The most visited legal book move for 'board'.  False if none.
+    bool bestMove(const Board& board, BookMove& out) const;
+
+    // All records, in file order (for merging into a new book).
+    const BookRecord* records() const { return records_; }
+
+private:
+    // [first, last) range of records with 'key'.
+    void findRange(std::uint64_t key, std::size_t& first, std::size_t& last) const;
+
+    const BookRecord* records_ = nullptr;
+    std::size_t       count_ = 0;
+
+    void*       mapping_ = nullptr;  // whole file, header included
+    std::size_t mappingSize_ = 0;
+    std::vector<unsigned char> buffer_;  // non-POSIX fallback
+};
+
+// Accumulates (position, move, score) samples and writes a book.
+//
+// Samples of the same position (in any orientation) and move are merged:
+// visits add up and scores are averaged, weighted by visits.
+class OpeningBookBuilder {
+public:
+    // One visit of 'move' from 'board'; 'score' is from the perspective of
+    // the side to move at 'board'.
+    void add(const Board& board, const Move& move, int score, std::uint32_t visits = 1);
+
+    // Add every record of an existing book.
+    void add(const OpeningBook& book);
+
+    std::size_t size() const { return records_.size(); }
+
+    // Merge, sort and write to 'path' (replacing it).  Records with fewer
+    // than 'minVisits' visits are dropped.  Returns false on I/O error.
+    bool write(const std::string& path, std::uint32_t minVisits = 1);
+
+private:
+    void addRecord(const BookRecord& r);
+
+    std::vector<BookRecord> records_;
+};
+
+} // namespace gomoku
+
+#endif // GOMOKU_SEARCH_OPENING_BOOK_H
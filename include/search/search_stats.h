@@ -0,0 +1,88 @@
+#ifndef GOMOKU_SEARCH_SEARCH_STATS_H
+#define GOMOKU_SEARCH_SEARCH_STATS_H
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define GOMOKU_STATS_TSC 1
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#define GOMOKU_STATS_TSC 1
+#include <x86intrin.h>
+#endif
+
+// Search instrumentation: the counters and phase timers behind
+// SearchEngine's per-iteration SearchInfo.
+//
+// Build with -DGOMOKU_SEARCH_STATS=0 to compile them out: GOMOKU_STATS()
+// statements vanish and PhaseTimer is an empty object, so the search hot
+// path carries no instrumentation at all.  Node counts and hash hits are
+// part of SearchResult and are always kept.
+#ifndef GOMOKU_SEARCH_STATS
+#define GOMOKU_SEARCH_STATS 1
+#endif
+
+#if GOMOKU_SEARCH_STATS
+#define GOMOKU_STATS(statement) statement
+#else
+#define GOMOKU_STATS(statement) ((void)0)
+#endif
+
+namespace gomoku {
+
+// Cheap monotonic tick counter: the time-stamp counter on x86 (a few
+// cycles, no system call), steady_clock nanoseconds elsewhere.  Ticks are
+// converted to time against steady_clock over a whole search.
+inline std::uint64_t statsTicks() {
+#if defined(GOMOKU_STATS_TSC)
+    return __rdtsc();
+#else
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+// Search phases with their own timer.
+enum class SearchPhase : std::uint8_t {
+    Threats,   // IThreatSolver analyzeThreats() / collectForcingMoves()
+    Eval,      // IEvaluator::evaluate()
+    MoveGen,   // MovePicker::next()
+    Count
+};
+
+// Counters of one search thread, cleared per search.
+struct SearchStats {
+    std::uint64_t ttProbes = 0;
+    std::uint64_t cutoffs = 0;           // beta cutoffs in the main search
+    std::uint64_t firstMoveCutoffs = 0;  // ... by the first move searched
+    int           selDepth = 0;          // deepest ply reached, quiescence included
+    std::uint64_t phaseTicks[static_cast<int>(SearchPhase::Count)] = {};
+
+    void reset() { *this = SearchStats(); }
+};
+
+// Adds the ticks of its scope to one phase of 'stats'.
+class PhaseTimer {
+public:
+#if GOMOKU_SEARCH_STATS
+    PhaseTimer(SearchStats& stats, SearchPhase phase)
+        : ticks_(stats.phaseTicks[static_cast<int>(phase)]), start_(statsTicks()) {}
+    ~PhaseTimer() { ticks_ += statsTicks() - start_; }
+#else
+    PhaseTimer(SearchStats&, SearchPhase) {}
+#endif
+
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+#if GOMOKU_SEARCH_STATS
+private:
+    std::uint64_t& ticks_;
+    std::uint64_t  start_;
+#endif
+};
+
+} // namespace gomoku
+
+#endif // GOMOKU_SEARCH_SEARCH_STATS_H
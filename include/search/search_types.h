@@ -0,0 +1,158 @@
+#ifndef GOMOKU_SEARCH_TYPES_H
+#define GOMOKU_SEARCH_TYPES_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <limits>
+#include "core/board.h"
+#include "tactics/Ithreat_solver.h"
+
+namespace gomoku {
+
+// Scoring type.
+using EvalScore = int;
+
+// Constants used across the search implementation.
+static constexpr EvalScore kInfinity   = std::numeric_limits<EvalScore>::max() / 4;
+static constexpr EvalScore kMateScore  = kInfinity - 1000;  // Score for immediate win.
+static constexpr EvalScore kDrawScore  = 0;
+
+// Deepest ply the search can reach (main search + quiescence).
+static constexpr int kMaxPly = 64;
+
+// Scores beyond this magnitude encode a forced win/loss; the distance to mate
+// (in plies) is kMateScore - |score|.
+static constexpr EvalScore kMateThreshold = kMateScore - 1000;
+
+inline bool isMateScore(EvalScore s) {
+    return s >= kMateThreshold || s <= -kMateThreshold;
+}
+
+// Search limits control how far and how long search is allowed to go.
+//
+// Time: timeLimitMs is a hard cap per move.  With a game clock
+// (remainingTimeMs != 0) the per-move budget is derived from the clock and
+// increment instead, still capped by timeLimitMs if that is non-zero.  See
+// TimeManager for the soft/hard limits and panic mode.
+struct SearchLimits {
+    int maxDepth = 32;
+    std::uint64_t maxNodes = 0;
+    std::uint64_t timeLimitMs = 1000;
+    std::uint64_t remainingTimeMs = 0;  // Our game clock; 0 = no clock, use timeLimitMs.
+    std::uint64_t incrementMs = 0;      // Added to our clock after each move.
+    int movesToGo = 0;                  // Moves until the clock is refilled; 0 = estimate.
+    std::uint64_t panicExtraTimeMs = 300;
+    bool enableNullMove = true;
+    bool enablePanicMode = true;
+    std::size_t ttSizeMB = 0;        // Transposition table size; 0 keeps the current size.
+    int threads = 1;                 // Search threads (Lazy SMP); 1 = single-threaded.
+    bool enableRootProofs = false;   // When the opponent threatens a win, prove/refute every
+                                     // root move first (on 'threads' threads).
+    std::uint64_t dfpnMaxNodes = 0;  // When the root threat search finds a forced win for
+                                     // either side, confirm it with full-width df-pn
+                                     // (DfpnSolver) in at most this many nodes and the soft
+                                     // time limit (half of it for a loss); 0 = off.  Wins
+                                     // found by the threat search typically need 10k-100k.
+
+    // Optional stop token, owned by the caller.  Setting it from any thread
+    // stops the search (and its threat searches) promptly.  searchBestMove()
+    // clears it on entry and sets it when the search ends.
+    std::atomic<bool>* stopToken = nullptr;
+};
+
+// Node counter written by one search thread and read by others.  The
+// owner increments with a plain load/store (no locked instruction); the
+// alignment keeps each thread's counter on its own cache line.
+class alignas(64) NodeCounter {
+public:
+    void increment() { value_.store(value_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+    void add(std::uint64_t n) { value_.store(value_.load(std::memory_order_relaxed) + n, std::memory_order_relaxed); }
+    void reset() { value_.store(0, std::memory_order_relaxed); }
+    std::uint64_t get() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<std::uint64_t> value_{0};
+};
+
+// Detailed result of a single move search.
+struct SearchResult {
+    Move       bestMove;         // Selected root move.
+    EvalScore  bestScore = 0;    // Score from perspective of rootSideToMove (fixed at start of search).
+    int        depthReached = 0; // Deepest fully completed iteration.
+    bool       isMate = false;   // True if bestScore indicates a forced win/loss.
+    bool       isTimeout = false;// True if search stopped due to time.
+    bool       isForcedWin = false; // True if ThreatSolver proved a win at root.
+    bool       isProvenWin = false;  // isForcedWin proven against every defence by full-width
+                                     // df-pn (SearchLimits::dfpnMaxNodes).
+    bool       isProvenLoss = false; // The opponent's forced win, proven the same way.
+    bool       isBookMove = false;   // bestMove came from the opening book; no search ran.
+
+    std::vector<Move> principalVariation;
+
+    std::uint64_t nodes = 0;
+    std::uint64_t qnodes = 0;
+    std::uint64_t hashHits = 0;
+    std::uint64_t threatCacheHits = 0;   // analyzeThreats() results reused
+    std::uint64_t threatCacheMisses = 0; // analyzeThreats() results computed
+};
+
+// Progress report of one completed iteration (SearchEngine::setInfoCallback()).
+//
+// Counts and times cover the search so far.  Rates are fractions in [0,1]
+// and the phase times are the main thread's; with GOMOKU_SEARCH_STATS=0
+// (search_stats.h) selDepth, the TT hit rate, the cutoff rate and the
+// phase times read 0.
+struct SearchInfo {
+    int        depth = 0;
+    int        selDepth = 0;          // deepest ply reached, quiescence included
+    EvalScore  score = 0;             // from the perspective of rootSideToMove
+    bool       isMate = false;
+    std::vector<Move> principalVariation;
+
+    std::uint64_t nodes = 0;          // nodes + qnodes, all threads
+    std::uint64_t timeMs = 0;
+    std::uint64_t nps = 0;
+    int           hashfull = 0;       // TT occupancy by this search, permille
+
+    double ttHitRate = 0.0;           // TT probes that found an entry
+    double threatCacheHitRate = 0.0;  // analyzeThreats() answered by the cache
+    double firstMoveCutoffRate = 0.0; // beta cutoffs made by the first move
+
+    double threatMs = 0.0;            // threat analysis
+    double evalMs = 0.0;              // static evaluation
+    double moveGenMs = 0.0;           // move generation and ordering
+};
+
+class TranspositionTable;
+class IEvaluator;
+
+// RAII helper for make/unmake move safety.  If a threat solver or an
+// evaluator is given it is notified after every make and unmake, so its
+// incremental state follows the search.  If a transposition table is given,
+// the child's cluster is prefetched right after the move is made.
+class MoveGuard {
+public:
+    MoveGuard(Board& board, const Move& move,
+              IThreatSolver* threatSolver = nullptr,
+              const TranspositionTable* tt = nullptr,
+              IEvaluator* evaluator = nullptr);
+    ~MoveGuard();
+
+    MoveGuard(const MoveGuard&) = delete;
+    MoveGuard& operator=(const MoveGuard&) = delete;
+
+    bool isValid() const { return valid_; }
+
+private:
+    Board&         board_;
+    Move           move_;
+    IThreatSolver* threatSolver_;
+    IEvaluator*    evaluator_;
+    bool           valid_;
+};
+
+} // namespace gomoku
+
+#endif // GOMOKU_SEARCH_TYPES_H
\ No newline at end of file
@@ -1,35 +1,110 @@
 #ifndef GOMOKU_SEARCH_TIME_MANAGER_H
 #define GOMOKU_SEARCH_TIME_MANAGER_H
 
+#include <atomic>
 #include <chrono>
 #include <cstdint>
+#include "core/board.h"
 #include "search/search_types.h"
 
 namespace gomoku {
 
+// Stop signalling and budget checks for one search thread.
+//
+// The stop flag is SearchLimits::stopToken when the caller provides one
+// (so any thread may stop the search, and Lazy SMP helpers share the main
+// thread's flag), otherwise a flag owned by this TimeManager.  Reading the
+// flag is a relaxed atomic load and is done at every node; the clock and
+// the node budget are only read every kPollInterval nodes (see tick()).
+//
+// Time allocation:
+//   * Hard limit: the search stops as soon as it is reached.  Fixed
+//     (timeLimitMs) or derived from the game clock: a share of the
+//     remaining time plus most of the increment, never more than a quarter
+//     of the clock.
+//   * Soft limit (half the hard limit): no new iteration starts after it.
+//     It shrinks to a quarter of the hard limit once the best move has been
+//     the same for kStableIterations iterations.
+//   * Panic mode (enablePanicMode): when the root score drops by more than
+//     kPanicScoreDrop between iterations, or the opponent has a forced win
+//     at the root, the soft limit doubles and the hard limit grows by
+//     panicExtraTimeMs (within the clock).
 class TimeManager {
 public:
     using Clock = std::chrono::steady_clock;
 
-    // Initialize with limits for a new search.
+    // Nodes between two clock reads.  A power of two.
+    static constexpr std::uint32_t kPollInterval = 128;
+
+    static constexpr int           kStableIterations = 3;
+    static constexpr EvalScore     kPanicScoreDrop   = 50;
+    static constexpr int           kDefaultMovesToGo = 20;
+    static constexpr std::uint64_t kMoveOverheadMs   = 30; // reserved for communication
+
+    // Initialize with limits for a new search.  Clears the owned flag but
+    // never the caller's stopToken.
     void start(const SearchLimits& limits);
 
     // Check if search should stop.
     // updates internal stop flag.
-    // @param nodesVisited: accumulated nodes + qnodes.
-    // @param inPanic: if true, uses panicExtraTimeMs.
+    // @param nodesVisited: accumulated nodes + qnodes (all threads).
+    // @param inPanic: if true, uses panicExtraTimeMs (as does panic mode
+    //                 entered through the calls below).
     bool checkStopCondition(std::uint64_t nodesVisited, bool inPanic = false);
 
-    bool isStopped() const { return stop_; }
+    // Count one node; true every kPollInterval calls, i.e. when the caller
+    // should run checkStopCondition().
+    bool tick() { return (++ticks_ & (kPollInterval - 1)) == 0; }
+
+    // --- Iteration control (main search thread) ---
+
+    // Report a completed iteration (score from the perspective of
+    // rootSideToMove at the start of the search).
+    void onIterationComplete(const Move& bestMove, EvalScore score);
+
+    // The opponent has a forcing line at the root.
+    void onRootDanger() { panic_ = true; }
+
+    // False once the soft limit has passed: another iteration would most
+    // likely not finish, or is not needed.
+    bool canStartIteration() const;
+
+    bool inPanic() const { return panic_ && limits_.enablePanicMode; }
+
+    bool isStopped() const { return stop_->load(std::memory_order_relaxed); }
+
+    // Stop the search from another thread (e.g. the main Lazy SMP thread
+    // stopping its helpers).
+    void requestStop() { stop_->store(true, std::memory_order_relaxed); }
+
+    // The flag in use, for sharing with helper threads and the threat
+    // solver (ThreatSearchLimits::abortFlag).
+    std::atomic<bool>* stopFlag() const { return stop_; }
     
     std::uint64_t elapsedMs() const;
 
+    // Budgets of the current search in ms; 0 = unlimited.
+    std::uint64_t softLimitMs() const { return softMs_; }
+    std::uint64_t hardLimitMs() const { return hardMs_; }
+
 private:
-    Clock::time_point startTime_;
-    SearchLimits      limits_;
-    bool              stop_ = false;
+    Clock::time_point  startTime_;
+    SearchLimits       limits_;
+    std::atomic<bool>  ownStop_{false};
+    std::atomic<bool>* stop_ = &ownStop_;
+    std::uint32_t      ticks_ = 0;
+
+    std::uint64_t softMs_ = 0;
+    std::uint64_t hardMs_ = 0;
+    std::uint64_t panicHardMs_ = 0;  // hard limit in panic mode
+
+    bool      panic_ = false;
+    bool      haveIteration_ = false;
+    Move      lastBestMove_;
+    EvalScore lastScore_ = 0;
+    int       stableIterations_ = 0;
 };
 
 } // namespace gomoku
 
-#endif // GOMOKU_SEARCH_TIME_MANAGER_H
\ No newline at end of file
+#endif // GOMOKU_SEARCH_TIME_MANAGER_H
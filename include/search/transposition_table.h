@@ -1,8 +1,9 @@
 #ifndef GOMOKU_SEARCH_TRANSPOSITION_TABLE_H
 #define GOMOKU_SEARCH_TRANSPOSITION_TABLE_H
 
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
-#include <vector>
 #include "core/board.h"
 #include "search/search_types.h"
 
@@ -14,24 +15,80 @@ enum class TTNodeType : std::uint8_t {
     UpperBound   // alpha-beta upper bound (score <= value).
 };
 
+// Decoded view of a table entry, as returned by probe().
+//
+// Scores are stored from the perspective of the side to move at the stored
+// node, so entries stay valid across searches with different root sides.
+// SearchEngine converts them to/from rootSideToMove perspective at the
+// probe/store boundary.
 struct TTEntry {
     std::uint64_t key = 0;
-    EvalScore     value = 0; // from the perspective of rootSideToMove at the start of the search
-    EvalScore     eval = 0;  // from the perspective of rootSideToMove at the start of the search
+    EvalScore     value = 0; // from the perspective of the side to move at this node
+    EvalScore     eval = 0;  // from the perspective of the side to move at this node
     int           depth = -1;
     TTNodeType    type = TTNodeType::Exact;
-    Move          bestMove;
+    Move          bestMove = Move(-1, -1); // (-1,-1) if none
 };
 
+// Transposition table made of 64-byte clusters of four 16-byte entries, so
+// a probe touches exactly one cache line.
+//
+// Packed entry (two 64-bit words):
+//   check : key XOR data   (a torn write fails verification)
+//   data  : value (16) | eval (16) | depth (8) | generation:6 bound:2 (8)
+//           | move index 0..143, 0xFF = none (8) | unused (8)
+//
+// Scores are kept in 16 bits: mate scores keep their distance to mate,
+// other scores are clamped to ±kMaxStoredEval.
+//
+// Replacement inside a cluster: the slot holding the same key, else an
+// empty slot, else the slot with the lowest depth - 8 * age, where age is
+// the number of searches since the entry was written.
+//
+// Threads: the table is shared by all Lazy SMP search threads without
+// locks.  Both words are relaxed atomics; a slot written by two threads at
+// once fails the check and reads as a miss.
+//
+// Memory: sized in megabytes (rounded down to a power-of-two number of
+// clusters).  On Linux, tables of 2 MB or more are 2 MB aligned and marked
+// with madvise(MADV_HUGEPAGE) so transparent huge pages can back them; a
+// 1 GB table on 4 KB pages is otherwise TLB-bound.
 class TranspositionTable {
 public:
-    // Initialize with a default size (e.g., 2^20 entries).
-    explicit TranspositionTable(std::size_t size = 1048576);
+    static constexpr int         kClusterSize    = 4;
+    static constexpr EvalScore   kMaxStoredEval  = 30000;
+    static constexpr std::size_t kDefaultSizeMB  = 16; // 2^20 entries
+
+    explicit TranspositionTable(std::size_t sizeMB = kDefaultSizeMB);
+    ~TranspositionTable();
+
+    TranspositionTable(const TranspositionTable&) = delete;
+    TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+    // Reallocate to 'sizeMB' megabytes (at least one cluster) and clear.
+    // No-op if the size does not change.
+    void resize(std::size_t sizeMB);
+
+    std::size_t sizeMB() const { return (clusterCount_ * sizeof(Cluster)) >> 20; }
 
     void clear();
 
-    // Retrieve an entry. Returns nullptr if key doesn't match or empty.
-    TTEntry* probe(std::uint64_t key);
+    // Hint the CPU to load the cluster of 'key'.  Called right after a move
+    // is made so the line is in cache by the time the child node probes.
+    void prefetch(std::uint64_t key) const {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(&clusters_[key & mask_]);
+#else
+        (void)key;
+#endif
+    }
+
+    // Start a new search: entries from older searches become preferred
+    // replacement victims.
+    void newSearch();
+
+    // Retrieve the entry for 'key'.  Returns false if there is none.
+    bool probe(std::uint64_t key, TTEntry& out) const;
 
     // Store an entry using replacement policy.
     void store(std::uint64_t key,
@@ -41,14 +98,41 @@ public:
                TTNodeType    type,
                const Move&   bestMove);
 
+    std::size_t entryCount() const { return clusterCount_ * kClusterSize; }
+
+    // Occupancy in permille: entries written by the current search among
+    // the first 1000 clusters (all of them in smaller tables).  Cheap
+    // enough to call once per iteration.
+    int hashfull() const;
+
     // Normalize mate scores relative to root ply.
     static EvalScore toTTScore(EvalScore score, int plyFromRoot);
     static EvalScore fromTTScore(EvalScore score, int plyFromRoot);
 
 private:
-    std::vector<TTEntry> table_;
+    struct PackedEntry {
+        std::atomic<std::uint64_t> check{0};
+        std::atomic<std::uint64_t> data{0};
+    };
+
+    struct alignas(64) Cluster {
+        PackedEntry entries[kClusterSize];
+    };
+    static_assert(sizeof(Cluster) == 64, "a cluster must fill one cache line");
+
+    Cluster& clusterOf(std::uint64_t key) { return clusters_[key & mask_]; }
+    const Cluster& clusterOf(std::uint64_t key) const { return clusters_[key & mask_]; }
+
+    void allocate(std::size_t clusterCount);
+    void release();
+
+    Cluster*     clusters_ = nullptr;
+    std::size_t  clusterCount_ = 0;
+    std::size_t  alignment_ = alignof(Cluster);
+    std::size_t  mask_ = 0;
+    std::uint8_t generation_ = 0; // 6 bits
 };
 
 } // namespace gomoku
 
-#endif // GOMOKU_SEARCH_TRANSPOSITION_TABLE_H
\ No newline at end of file
+#endif // GOMOKU_SEARCH_TRANSPOSITION_TABLE_H
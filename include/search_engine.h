@@ -7,37 +7,189 @@
 #include "search/transposition_table.h"
 #include "search/time_manager.h"
 #include "search/history_heuristic.h"
+#include "search/move_selector.h"
+#include "search/opening_book.h"
+#include "search/search_stats.h"
+#include "tactics/dfpn_solver.h"
 #include "tactics/threat_solver.h"
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
 namespace gomoku {
 
 // The SearchEngine owns the search state for a single game.
 // It orchestrates PVS, Time Management, and Tactical solvers.
+//
+// With SearchLimits::threads > 1 the search runs Lazy SMP: helper threads
+// search their own copy of the root position (with clones of the
+// evaluator, threat solver and history) at staggered depths, sharing only
+// the transposition table.  The calling thread keeps the clock; its result
+// is reported unless a helper completed a deeper iteration.  Requires a
+// cloneable evaluator (IEvaluator::clone()); otherwise the search stays
+// single-threaded.
+//
+// Asynchronous use: startSearch() runs searchBestMove() on a background
+// thread; startPonder() searches the reply predicted by the last result's
+// principal variation on the opponent's time.  While a background search
+// runs, the board belongs to the engine: the caller must not touch it (or
+// the threat solver) until the search has completed or stop() returned.
+// The TT and history are kept from one search to the next, so a ponder hit
+// continues from everything the ponder search found.
 class SearchEngine {
 public:
+    using SearchCallback = std::function<void(const SearchResult&)>;
+    using InfoCallback   = std::function<void(const SearchInfo&)>;
+
     // SearchEngine constructor (Dependency Injection).
     // Dependencies (evaluator, threatSolver, history) must outlive SearchEngine.
+    // threatSolver and historyHeuristic may be nullptr.
     SearchEngine(Board&             board,
                  IEvaluator&        evaluator,
                  IThreatSolver* threatSolver,
                  IHistoryHeuristic* historyHeuristic);
+    ~SearchEngine();
+
+    SearchEngine(const SearchEngine&) = delete;
+    SearchEngine& operator=(const SearchEngine&) = delete;
 
     // Compute the best move within limits.
     SearchResult searchBestMove(const SearchLimits& limits);
 
+    // --- Asynchronous search ---
+
+    // Start searchBestMove(limits) in the background and return at once.
+    // onDone (optional) is called on the search thread with the result,
+    // which the returned future also carries.  A running background search
+    // is stopped first.
+    std::future<SearchResult> startSearch(const SearchLimits& limits,
+                                          SearchCallback onDone = SearchCallback());
+
+    // Ponder: call after our last search's move has been played on the
+    // board.  Plays the predicted reply (principalVariation[1] of the last
+    // result) on the board and searches it without a time limit until
+    // ponderhit() or stop().  'limits' are the limits of the real search
+    // that follows a ponder hit.  Returns an invalid future (valid() ==
+    // false) if there is no prediction.
+    std::future<SearchResult> startPonder(const SearchLimits& limits,
+                                          SearchCallback onDone = SearchCallback());
+
+    // The opponent played 'move'.  On a hit (move is the predicted reply)
+    // the predicted move stays on the board as the real one and the ponder
+    // search turns into a normal search with the startPonder() limits; its
+    // result completes the future and calls onDone.  On a miss the ponder
+    // search is stopped and the predicted move taken back before this
+    // returns; the future then holds an empty result (bestMove (-1,-1)).
+    bool ponderhit(const Move& move);
+
+    // Stop any background search and wait for it.  A stopped normal
+    // search still reports its best move; a stopped ponder search takes
+    // its predicted move back and reports an empty result.
+    void stop();
+
+    bool isSearching() const { return asyncRunning_.load(std::memory_order_acquire); }
+    bool isPondering() const;
+    Move ponderMove() const { return ponderMove_; }
+
+    // Not synchronised with a running background search.
     const SearchResult& getLastSearchResult() const { return lastResult_; }
 
+    // New game only: between moves, entries of older searches are kept and
+    // merely lose priority in replacement (TranspositionTable::newSearch()).
     void clearTranspositionTable() { tt_.clear(); }
 
+    // Resize the transposition table in place (clears it).  Same effect as
+    // SearchLimits::ttSizeMB on the next search.
+    void setHashSizeMB(std::size_t sizeMB) { tt_.resize(sizeMB); }
+    std::size_t hashSizeMB() const { return tt_.sizeMB(); }
+
+    // Play from 'book' (may be nullptr to disable; must outlive the engine):
+    // a position with a legal book move returns its most visited move at
+    // once, without searching (SearchResult::isBookMove).
+    void setOpeningBook(const OpeningBook* book) { book_ = book; }
+
+    // Called on the search thread after every completed iteration of the
+    // main thread (not for book moves or root threat wins, which run no
+    // iterations).  Empty to disable.  Not to be changed while a search runs.
+    void setInfoCallback(InfoCallback onInfo) { onInfo_ = std::move(onInfo); }
+
 private:
+    struct HelperThread;
+
+    // Helper-thread engine: searches 'board' with the shared table 'tt'.
+    SearchEngine(Board&             board,
+                 IEvaluator&        evaluator,
+                 IThreatSolver*     threatSolver,
+                 IHistoryHeuristic* historyHeuristic,
+                 TranspositionTable& tt);
+
+    // searchBestMove() without clearing limits.stopToken first.
+    SearchResult runSearch(const SearchLimits& limits);
+
+    // Reset the per-search state and start the clock.
+    void prepareSearch(const SearchLimits& limits);
+
+    // Search reuse across moves: if the root is the previous root followed
+    // by the first moves of the previous PV, re-seed the TT with the rest of
+    // that PV, use its next move as the fallback and return the depth to
+    // start iterating from; 1 otherwise.
+    int seedFromPreviousSearch();
+    void rememberSearch();
+
+    // Build the SearchInfo of the iteration that just completed and pass
+    // it to onInfo_.
+    void reportIteration(int depth, EvalScore score);
+
+    // nodes + qnodes of this thread and all running helpers.
+    std::uint64_t totalNodes() const;
+
+    // Per-node stop check: the stop flag every node, clock and node budget
+    // every TimeManager::kPollInterval nodes.
+    bool shouldStop() {
+        if (timeManager_.isStopped()) return true;
+        return timeManager_.tick() && timeManager_.checkStopCondition(totalNodes());
+    }
+
+    // Lazy SMP: start limits_.threads - 1 helpers on the current root, and
+    // stop them again, folding their counters and any deeper result into
+    // lastResult_.
+    void startHelpers();
+    void joinHelpers();
+
+    // Root threat proofs (SearchLimits::enableRootProofs), run when the
+    // opponent threatens a forced win ('opp'): prove or refute each root
+    // move.  Returns true if a proven win was stored in lastResult_; proven
+    // losses are excluded from the root search.
+    bool proveRootMoves(const MoveList& candidates, const ThreatAnalysis& opp);
+    // Full-width df-pn check of a forced win of 'attacker' at the root found
+    // by the threat search (SearchLimits::dfpnMaxNodes).  True if proven.
+    bool confirmWithDfpn(Player attacker);
+    bool isRootExcluded(const Move& m) const {
+        const int idx = m.y * 12 + m.x;
+        return (rootExcluded_[idx >> 6] >> (idx & 63)) & 1ULL;
+    }
+
     // --- Core Search ---
     // Returns score from the perspective of rootSideToMove at the start of the search
     EvalScore search(int depth, EvalScore alpha, EvalScore beta, int ply, bool allowNull, bool inPV);
+    // Threat-only quiescence at the horizon: stand pat on the evaluator,
+    // answer a four with its block, extend own fours (and threes for the
+    // first plies).  qply counts plies since the horizon.
     // Returns score from the perspective of rootSideToMove at the start of the search
-    EvalScore quiescence(EvalScore alpha, EvalScore beta, int ply);
-    void iterativeDeepening();
+    EvalScore quiescence(EvalScore alpha, EvalScore beta, int ply, int qply);
+    // threadIndex 0 is the main thread; helpers skip some depths.
+    void iterativeDeepening(int threadIndex);
 
     // --- Helpers ---
+    // threatInfo: the opponent's threat analysis at this node.
     bool canDoNullMove(const ThreatAnalysis& threatInfo, int depth, int ply) const;
     EvalScore nullMoveSearch(EvalScore alpha, EvalScore beta, int depth, int ply);
     void extractPrincipalVariation(std::vector<Move>& outPV, int maxDepth);
@@ -49,17 +201,61 @@ private:
     IHistoryHeuristic* history_;
 
     // --- Internal Components ---
-    TranspositionTable tt_;
+    std::unique_ptr<TranspositionTable> ownTT_;   // null in helper engines
+    TranspositionTable& tt_;                      // *ownTT_ or the main engine's
     TimeManager        timeManager_;
+    std::vector<std::unique_ptr<HelperThread>> helpers_;
+    std::unique_ptr<DfpnSolver> dfpn_;            // created on first use
+    const OpeningBook* book_ = nullptr;
+    InfoCallback       onInfo_;
+
+    // --- Asynchronous search ---
+    enum class PonderState : std::uint8_t { None, Pondering, Hit, Miss };
+
+    std::thread             asyncThread_;
+    std::atomic<bool>       asyncRunning_{false};
+    std::atomic<bool>       asyncStop_{false};
+    std::atomic<bool>*      asyncStopFlag_ = &asyncStop_; // token of the running search
+    mutable std::mutex      ponderMutex_;
+    std::condition_variable ponderCv_;
+    PonderState             ponderState_ = PonderState::None;
+    bool                    stopRequested_ = false;
+    Move                    ponderMove_ = Move(-1, -1);
 
     // --- Search State ---
     Player             rootSide_;
+    SearchLimits       limits_;
     SearchResult       lastResult_;
+    Move               rootBestMove_;    // best move of the current iteration
+    std::uint64_t      rootExcluded_[3] = {0ULL, 0ULL, 0ULL}; // proven-losing root moves
+    int                startDepth_ = 1;  // first iteration depth
+
+    // Previous search (for seedFromPreviousSearch()).
+    std::uint64_t      prevRootKey_ = 0;
+    int                prevRootStones_ = -1;
+    int                prevDepth_ = 0;
+    std::vector<Move>  prevPV_;
+
+    // Move generation scratch, one buffer per ply (allocated once).
+    std::vector<MoveBuffer> plyBuffers_;
+
+    // Move played at each ply of the current path ((-1,-1) for a null
+    // move), for countermoves.
+    Move               playedAt_[kMaxPly];
     
     // Statistics counters (cleared per search)
-    std::uint64_t      nodes_ = 0;
-    std::uint64_t      qnodes_ = 0;
+    NodeCounter        nodes_;
+    NodeCounter        qnodes_;
     std::uint64_t      hashHits_ = 0;
+    std::uint64_t      threatCacheHits_ = 0;
+    std::uint64_t      threatCacheMisses_ = 0;
+    ThreatCacheStats   threatCacheAtStart_;
+
+    // Instrumentation (search_stats.h), cleared per search; the start
+    // time and ticks convert phase ticks to milliseconds.
+    SearchStats        stats_;
+    std::uint64_t      statsStartTicks_ = 0;
+    std::chrono::steady_clock::time_point statsStartTime_;
 };
 
 } // namespace gomoku
@@ -1,13 +1,25 @@
 #ifndef GOMOKU_TACTICS_THREAT_SOLVER_H
 #define GOMOKU_TACTICS_THREAT_SOLVER_H
 
-#include <vector>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include "core/board.h"
+#include "core/inline_vector.h"
 
 // Abstract threat solver API.
 
 namespace gomoku {
 
+// Capacity bounds of the inline result buffers.  Threat results are
+// produced at every search node, so they never touch the heap.
+constexpr std::size_t kMaxThreatSequenceMoves = 40;  // attacker moves in one sequence
+constexpr std::size_t kMaxDefensiveMoves      = 144; // every cell of the 12×12 board
+
+using ThreatLineMoves    = InlineVector<Move, kMaxThreatSequenceMoves>;
+using DefensiveMoveList  = InlineVector<Move, kMaxDefensiveMoves>;
+
 struct ThreatAnalysis {
     // If true, 'attacker' has a forcing winning sequence assuming optimal defense.
     bool attackerHasForcedWin = false;
@@ -16,10 +28,65 @@ struct ThreatAnalysis {
     Move firstWinningMove;
 
     // Optional: entire sequence of moves in the winning line.
-    std::vector<Move> winningLine;
+    ThreatLineMoves winningLine;
 
     // The set of defender moves that *jointly* defend against all threat sequences.
-    std::vector<Move> defensiveMoves;
+    DefensiveMoveList defensiveMoves;
+};
+
+/**
+ * @brief Limits and optional abort flag for a single threat search call.
+ */
+struct ThreatSearchLimits {
+    /// Maximum number of internal nodes (threat/combo nodes) to explore.
+    int maxNodes = 200000;
+
+    /// Maximum logical depth (number of threat layers).
+    int maxDepth = 20;
+
+    /// Optional external abort flag (owned by caller). If non-null and set
+    /// to true during search, the solver will stop early and return “no info”.
+    /// May be set from another thread.
+    const std::atomic<bool>* abortFlag = nullptr;
+
+    /// Second abort flag, polled with abortFlag, so that a search can be
+    /// stopped both by its caller and by a flag of its own (e.g. the
+    /// cancel flag of a batch of searches).
+    const std::atomic<bool>* extraAbortFlag = nullptr;
+};
+
+// Verdict on one root move (see IThreatSolver::proveRootMoves()).
+enum class RootMoveProof : std::uint8_t {
+    Unknown, // not proven either way (budget exhausted or cancelled)
+    Win,     // the move wins for the side to move
+    Loss     // the opponent has a forced win after the move
+};
+
+struct RootProofResult {
+    // proofs[i] is the verdict on moves[i] of the request.
+    InlineVector<RootMoveProof, kMaxDefensiveMoves> proofs;
+
+    // A proven win (the first one found); the other tasks are cancelled.
+    bool foundWin = false;
+    Move winningMove;
+
+    // Every move is a proven loss.
+    bool allLost = false;
+};
+
+// Moves by which one player makes a five, a four (simple or open) or a
+// three (open or broken) in some direction.  Each move is listed once,
+// under its strongest threat.
+struct ForcingMoves {
+    MoveList fives;
+    MoveList fours;
+    MoveList threes;
+};
+
+// Hit/miss counters of a solver's analysis cache (zero if it has none).
+struct ThreatCacheStats {
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
 };
 
 // Abstract threat solver API.
@@ -31,10 +98,51 @@ public:
     // Must NOT modify 'board'.
     virtual ThreatAnalysis analyzeThreats(const Board& board, Player attacker) = 0;
 
+    // Same, with an explicit search budget.  Solvers without limits may
+    // ignore them.
+    virtual ThreatAnalysis analyzeThreats(const Board& board, Player attacker,
+                                          const ThreatSearchLimits& limits) {
+        (void)limits;
+        return analyzeThreats(board, attacker);
+    }
+
+    // Cumulative cache counters, for SearchResult statistics.
+    virtual ThreatCacheStats cacheStats() const { return ThreatCacheStats{}; }
+
     // Incremental state updates.
     virtual void notifyMove(const Move& move) = 0;
     virtual void notifyUndo(const Move& move) = 0;
-};
+
+    // Prove or refute each of 'moves' for the side to move on 'board',
+    // using up to 'threads' threads.  Each move gets its own search budget
+    // ('limits'); limits.abortFlag cancels the whole batch.  Solvers without
+    // support report every move as Unknown.
+    virtual RootProofResult proveRootMoves(const Board& board, const MoveList& moves,
+                                           int threads, const ThreatSearchLimits& limits) {
+        (void)board;
+        (void)threads;
+        (void)limits;
+        RootProofResult result;
+        for (std::size_t i = 0; i < moves.size(); ++i) result.proofs.push_back(RootMoveProof::Unknown);
+        return result;
+    }
+
+    // Forcing moves 'attacker' has on 'board' (no search, just the current
+    // threat shapes).  Returns false if unsupported.
+    virtual bool collectForcingMoves(const Board& board, Player attacker, ForcingMoves& out) {
+        (void)board;
+        (void)attacker;
+        out = ForcingMoves{};
+        return false;
+    }
+
+    // Solver for another search thread, synced to 'board' (that thread's own
+    // copy of the position).  Returns nullptr if unsupported; that thread
+    // then searches without threat analysis.
+    virtual std::unique_ptr<IThreatSolver> clone(const Board& board) const {
+        (void)board;
+        return nullptr;
+    }
 };
 
 } // namespace gomoku
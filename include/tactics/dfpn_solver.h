@@ -0,0 +1,117 @@
+// dfpn_solver.h
+//
+// Depth-first proof-number search (df-pn, Nagai 2002) for deciding whether
+// a player has a forced win by threats on a 12×12 Gomoku position.
+//
+// The tree is an AND/OR tree over real moves:
+//
+//   - OR nodes (attacker to move): the attacker may only play a forcing
+//     move (five, four or three, see IThreatSolver::collectForcingMoves),
+//     or the single block of a defender four.  A five is a proof; no
+//     forcing move left is a disproof.
+//   - AND nodes (defender to move): an attacker four leaves only its block
+//     (two five squares are a proof) and a defender five is a disproof.
+//     Against a three, the replies are the attacker's four squares (the
+//     defence points of its threes) and the defender's own fours, the same
+//     all-defences model the threat search uses.  With
+//     DfpnLimits::fullWidthDefence every empty cell is a reply instead.
+//
+// In full-width mode only the attacker is restricted, so pn = 0 proves a
+// win against every defence; the default mode misses quiet defences that
+// prepare a counter-attack, in exchange for a much smaller tree.  A
+// disproof only means there is no win by continuous threats.
+//
+// Proof and disproof numbers live in the solver's own table: fixed size
+// (set in megabytes), buckets of four entries, each entry tagged with the
+// work (nodes) spent below it.  A full bucket evicts its cheapest entry,
+// and when the table passes 90% load a garbage collection drops the
+// cheapest entries until it is half full.  The table survives solve()
+// calls, so consecutive solves (e.g. over a batch of positions for a
+// solved-positions database) reuse each other's results; clear() resets it.
+//
+// Not thread-safe: use one solver per thread.
+
+#ifndef GOMOKU_TACTICS_DFPN_SOLVER_H
+#define GOMOKU_TACTICS_DFPN_SOLVER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "core/board.h"
+
+namespace gomoku {
+
+enum class DfpnStatus : std::uint8_t {
+    Unknown,    ///< budget or time exhausted, or aborted
+    Proven,     ///< the attacker has a forced win
+    Disproven   ///< no forced win by threats
+};
+
+/**
+ * @brief Budget of one solve() call.
+ */
+struct DfpnLimits {
+    /// Node expansions; 0 means no node limit.
+    std::uint64_t maxNodes = 1000000;
+
+    /// Wall-clock limit in milliseconds; 0 means no time limit.
+    std::uint64_t timeLimitMs = 0;
+
+    /// Optional external abort flag (owned by caller), polled with the clock.
+    const std::atomic<bool>* abortFlag = nullptr;
+
+    /// Let the defender answer a three anywhere (exact, much slower).
+    bool fullWidthDefence = false;
+};
+
+struct DfpnResult {
+    DfpnStatus status = DfpnStatus::Unknown;
+
+    /// Proven with the attacker to move: the winning move.  Disproven with
+    /// the defender to move: a refuting reply.  (-1,-1) otherwise.
+    Move bestMove = Move(-1, -1);
+
+    std::uint64_t nodes = 0;  ///< node expansions of this call
+};
+
+class DfpnSolver {
+public:
+    static constexpr std::size_t kDefaultTableMB = 16;
+
+    explicit DfpnSolver(std::size_t tableMB = kDefaultTableMB);
+    ~DfpnSolver();
+
+    DfpnSolver(const DfpnSolver&) = delete;
+    DfpnSolver& operator=(const DfpnSolver&) = delete;
+
+    /**
+     * @brief Decide whether @p attacker wins @p board by threats.
+     *
+     * The solver works on its own copy of @p board; the side to move of
+     * @p board decides whether the root is an OR or an AND node.
+     */
+    DfpnResult solve(const Board& board, Player attacker, const DfpnLimits& limits = {});
+
+    /**
+     * @brief Status of @p board that is already settled in the table,
+     *        without searching.
+     */
+    DfpnStatus lookup(const Board& board, Player attacker,
+                      bool fullWidthDefence = false) const;
+
+    /// Drop every table entry.
+    void clear();
+
+    std::size_t tableEntries() const;  ///< capacity
+    std::size_t tableUsed() const;     ///< occupied entries
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+} // namespace gomoku
+
+#endif // GOMOKU_TACTICS_DFPN_SOLVER_H
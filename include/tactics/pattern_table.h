@@ -0,0 +1,140 @@
+// pattern_table.h
+//
+// Precomputed 1-D threat pattern tables for 12×12 Gomoku.
+//
+// A board line (row, column or diagonal) is split by opponent stones into
+// sub-lines; every threat lies entirely inside one sub-line of length
+// S ∈ [5,12].  For each S and each distribution of the attacker's stones in
+// that sub-line (stonesMask ∈ [0, 2^S)), the tables below answer in a single
+// lookup:
+//
+//   - Which threat does the attacker create by playing on empty offset c?
+//     (bestPatternAtCell)
+//   - Which threats already exist in this sub-line?  (candidatePatterns)
+//
+// Threats follow Czajka's (a,b) taxonomy.  A threat is identified by its
+// stone set T: the 5-cell windows of the sub-line whose attacker stones are
+// exactly T are its "ways", a = |T| and b = number of ways.  Only maximal
+// stone sets are reported (a set contained in a larger threat's set is
+// dropped).
+//
+// The tables are shared by every ThreatSolver and by the evaluator; they are
+// built once on first use and never modified afterwards.
+
+#ifndef GOMOKU_PATTERN_TABLE_H
+#define GOMOKU_PATTERN_TABLE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "tactics/threat_solver.h"
+
+namespace gomoku {
+
+/**
+ * @brief Shape of a 1-D threat, relative to the start of its window.
+ *
+ * The window is the span covered by the threat's ways, so every cell of the
+ * window is either in stonesMask or in emptyMask.
+ */
+struct ThreatPattern {
+    ThreatType type = ThreatType::None;
+
+    uint8_t windowLen = 0;       ///< Number of cells in the window (5..9).
+
+    // Bit i (0 <= i < windowLen) refers to offset i in the window.
+    uint16_t stonesMask    = 0;  ///< Must be attacker stones.
+    uint16_t emptyMask     = 0;  ///< Must be empty (includes defenses).
+    uint16_t defenseMask   = 0;  ///< Subset of emptyMask: legal defense points.
+    uint16_t finishingMask = 0;  ///< Subset of emptyMask: squares that turn the
+                                 ///< threat into a five (fours) or an open
+                                 ///< four (threes).  Empty for non-forcing threats.
+
+    uint8_t a = 0;               ///< Severity (stones towards five).
+    uint8_t b = 0;               ///< Multiplicity (ways to complete).
+
+    uint8_t patternId = 0;       ///< Index in PatternTable::patterns().
+};
+
+/**
+ * @brief A pattern placed inside a sub-line: @c anchor is the sub-line offset
+ *        of bit 0 of the pattern's window.
+ */
+struct PatternRef {
+    uint8_t patternId = 0;
+    uint8_t anchor    = 0;
+};
+
+class PatternTable {
+public:
+    /// Pattern id reserved for "no threat".
+    static constexpr uint8_t kNoPattern = 0;
+
+    static constexpr int kMinSubLine = GOMOKU_WIN_LENGTH;   // 5
+    static constexpr int kMaxSubLine = GOMOKU_MAX_LINE_LEN; // 12
+
+    /// Singleton accessor; builds the tables on first call (thread-safe).
+    static const PatternTable& instance();
+
+    /// All distinct threat shapes; index 0 is the "no threat" placeholder.
+    const std::vector<ThreatPattern>& patterns() const { return patterns_; }
+
+    const ThreatPattern& pattern(uint8_t id) const { return patterns_[id]; }
+
+    /**
+     * @brief Best pattern created by playing on empty offset @p cell of a
+     *        sub-line of length @p len holding attacker stones @p stonesMask.
+     *
+     * "Best" orders by severity, then multiplicity.  Returns kNoPattern if
+     * the cell is occupied or no threat through it exists.
+     */
+    uint8_t bestPatternAtCell(int len, uint32_t stonesMask, int cell) const {
+        return bestPatternAtCell_[bestBase_[len] + stonesMask * len + cell];
+    }
+
+    ThreatType bestThreatAtCell(int len, uint32_t stonesMask, int cell) const {
+        return patterns_[bestPatternAtCell(len, stonesMask, cell)].type;
+    }
+
+    /**
+     * @brief Maximal threats already present in a sub-line.
+     *
+     * Returns a pointer to the first entry and stores the entry count in
+     * @p outCount.  Entries are ordered best first.
+     */
+    const PatternRef* candidatePatterns(int len, uint32_t stonesMask,
+                                        int& outCount) const {
+        std::size_t slot = candidateBase_[len] + stonesMask;
+        outCount = static_cast<int>(candidateBegin_[slot + 1] - candidateBegin_[slot]);
+        return candidates_.data() + candidateBegin_[slot];
+    }
+
+    /**
+     * @brief Locate the instance of @p patternId that the stone on @p cell
+     *        belongs to, in a sub-line whose stones (including @p cell) are
+     *        @p stonesMask.
+     *
+     * @return the anchor offset, or -1 if the pattern does not occur there.
+     */
+    int findAnchor(int len, uint32_t stonesMask, uint8_t patternId, int cell) const;
+
+private:
+    PatternTable() = default;
+    void initializeOnce();
+
+    std::vector<ThreatPattern> patterns_;
+
+    // bestPatternAtCell_[bestBase_[S] + stonesMask * S + cell]
+    std::vector<uint8_t>  bestPatternAtCell_;
+    uint32_t              bestBase_[kMaxSubLine + 1] = {};
+
+    // candidates_[candidateBegin_[slot] .. candidateBegin_[slot+1]) with
+    // slot = candidateBase_[S] + stonesMask.
+    std::vector<PatternRef> candidates_;
+    std::vector<uint32_t>   candidateBegin_;
+    uint32_t                candidateBase_[kMaxSubLine + 1] = {};
+};
+
+} // namespace gomoku
+
+#endif // GOMOKU_PATTERN_TABLE_H
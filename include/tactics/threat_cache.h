@@ -0,0 +1,81 @@
+// threat_cache.h
+//
+// Bounded cache of ThreatAnalysis results for 12×12 Gomoku.
+//
+// The search engine asks for a threat analysis at every node, and the same
+// position is reached through many move orders.  ThreatCache remembers the
+// result per (Zobrist hash, attacker) so a transposition costs one probe
+// instead of a full threat-space search.
+//
+// Layout: a power-of-two array of 64-byte entries, one slot per key (always
+// replace).  Each entry is eight 64-bit words; word 0 stores the key XOR-ed
+// with the seven payload words, so a probe that races with a store sees a
+// key mismatch instead of a torn result.  Readers and writers never lock,
+// which lets solvers on different threads share one cache.
+//
+// Every entry records the node budget (ThreatSearchLimits::maxNodes) it was
+// computed with; a probe with a larger budget misses, so a deeper search can
+// replace a result that may have been cut short.
+
+#ifndef GOMOKU_THREAT_CACHE_H
+#define GOMOKU_THREAT_CACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "core/board.h"
+#include "tactics/Ithreat_solver.h"
+
+namespace gomoku {
+
+class ThreatCache {
+public:
+    /// Default capacity: 2^16 entries (4 MB).
+    static constexpr std::size_t kDefaultEntries = std::size_t(1) << 16;
+
+    /// Longest winning line / defensive set an entry can hold.  Larger
+    /// results are not cached.
+    static constexpr int kMaxLineMoves    = 24;
+    static constexpr int kMaxDefenseMoves = 24;
+
+    /// @param entries Requested capacity, rounded down to a power of two.
+    explicit ThreatCache(std::size_t entries = kDefaultEntries);
+
+    /// Key used for a position and attacker.
+    static uint64_t keyOf(uint64_t boardHash, Player attacker);
+
+    /**
+     * @brief Look up a result computed with at least @p nodeBudget nodes.
+     *
+     * @return true and fills @p out on a hit.  Counts a hit or a miss.
+     */
+    bool probe(uint64_t key, int nodeBudget, ThreatAnalysis& out) const;
+
+    /// Store a result computed with @p nodeBudget nodes (always replaces).
+    void store(uint64_t key, int nodeBudget, const ThreatAnalysis& analysis);
+
+    /// Drop every entry (not thread-safe against concurrent probes).
+    void clear();
+
+    ThreatCacheStats stats() const;
+    void resetStats();
+
+private:
+    static constexpr int kPayloadWords = 7;
+
+    struct Entry {
+        std::atomic<uint64_t> words[1 + kPayloadWords];
+    };
+
+    std::unique_ptr<Entry[]> table_;
+    std::size_t              mask_ = 0;
+
+    mutable std::atomic<uint64_t> hits_{0};
+    mutable std::atomic<uint64_t> misses_{0};
+};
+
+} // namespace gomoku
+
+#endif // GOMOKU_THREAT_CACHE_H
@@ -16,21 +16,34 @@
 #ifndef GOMOKU_THREAT_SOLVER_H
 #define GOMOKU_THREAT_SOLVER_H
 
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <vector>
 
 #include "core/board.h"             // Path updated to match structure
 #include "tactics/Ithreat_solver.h" // [NEW] Include the interface
+#include "tactics/threat_cache.h"
 
 namespace gomoku {
 
+// -----------------------------------------------------------------------------
+// Board geometry constants
+// -----------------------------------------------------------------------------
+
+constexpr int GOMOKU_BOARD_SIZE   = 12;
+constexpr int GOMOKU_WIN_LENGTH   = 5;
+constexpr int GOMOKU_MAX_LINE_LEN = GOMOKU_BOARD_SIZE; // 12 for 12×12
+
 // -----------------------------------------------------------------------------
 // Basic enums used by the solver
 // -----------------------------------------------------------------------------
 
 /**
  * @brief Directions in which threats can appear.
+ *
+ * Values match the direction indices of Board's line bitboards
+ * (Board::getLine), so a Direction can be passed there after a cast.
  */
 enum class Direction : uint8_t {
     Horizontal = 0,  ///< Along a row (x changes, y fixed)
@@ -75,54 +88,81 @@ enum class ThreatType : uint8_t {
     OneOneWay      ///< (1,1)
 };
 
+/// Enum order is strongest first, so a smaller value is a stronger threat.
+inline bool isStrongerThreat(ThreatType a, ThreatType b) {
+    if (a == ThreatType::None) return false;
+    return b == ThreatType::None || a < b;
+}
+
+/// Five, OpenFour, SimpleFour, OpenThree or BrokenThree.
+inline bool isForcingOrWinning(ThreatType t) {
+    return t != ThreatType::None && t <= ThreatType::BrokenThree;
+}
+
 // -----------------------------------------------------------------------------
 // Threat primitives exposed to the rest of the engine
 // -----------------------------------------------------------------------------
 
+/// Bounds of a single 1-D threat: at most five stones, and a window of at
+/// most 9 cells (so at most 8 empties, defenses or finishing squares).
+constexpr std::size_t kMaxThreatStones  = GOMOKU_WIN_LENGTH;
+constexpr std::size_t kMaxThreatEmpties = 8;
+
+/// Defense points per forcing threat are at most 3, so a sequence needs at
+/// most three defender replies per attacker move.
+constexpr std::size_t kMaxThreatSequenceDefenses = 3 * kMaxThreatSequenceMoves;
+
 /**
  * @brief Concrete threat instance on the board for a given player.
  *
- * All coordinates are absolute board moves (0 ≤ x,y < 12).
+ * All coordinates are absolute board moves (0 ≤ x,y < 12).  Storage is
+ * inline (InlineVector), so instances can be built and copied on the
+ * tactical hot path without allocating.
  */
 struct ThreatInstance {
     ThreatType type       = ThreatType::None;     ///< Type/strength of threat.
     Player     attacker   = Player::Black;        ///< Player that owns the threat.
     Direction  direction  = Direction::Horizontal;///< Direction of the line.
 
+    // Attacker move that creates this threat (Allis' "gain square").  It is
+    // also listed in stones.
+    Move gainSquare;
+
     // Stones that belong to the attacker and are part of the pattern.
-    std::vector<Move> stones;
+    InlineVector<Move, kMaxThreatStones> stones;
 
     // Empty squares that are required to remain empty for the threat to work
     // (includes defense points and auxiliary empties).
-    std::vector<Move> requiredEmpty;
+    InlineVector<Move, kMaxThreatEmpties> requiredEmpty;
 
     // Squares where the defender can legally defend this threat.
-    std::vector<Move> defensePoints;
+    InlineVector<Move, kMaxThreatEmpties> defensePoints;
 
     // Squares the attacker can later play on to convert this threat into a
     // stronger/winning threat (e.g. open-three → open-four).
-    std::vector<Move> finishingMoves;
+    InlineVector<Move, kMaxThreatEmpties> finishingMoves;
 };
 
 /**
  * @brief A forcing threat sequence for a single attacking player.
  *
  * This is a tactical line that (if valid and not refuted) should end in
- * a winning threat (Five or OpenFour).
+ * a winning threat (Five or OpenFour).  The search never produces more than
+ * kMaxThreatSequenceMoves threats.
  */
 struct ThreatSequence {
     /// Player for whom this sequence is winning.
     Player attacker = Player::Black;
 
     /// Threats in logical order, respecting dependencies.
-    std::vector<ThreatInstance> threats;
+    InlineVector<ThreatInstance, kMaxThreatSequenceMoves> threats;
 
     /// Concrete moves for the attacker in this sequence (in play order).
-    std::vector<Move> attackerMoves;
+    ThreatLineMoves attackerMoves;
 
     /// Concrete moves for the defender in this sequence, under the
     /// “all-defenses” assumption (may contain multiple responses per threat).
-    std::vector<Move> defenderMoves;
+    InlineVector<Move, kMaxThreatSequenceDefenses> defenderMoves;
 };
 
 /**
@@ -133,27 +173,8 @@ struct ThreatSequence {
  * alive; the search engine should focus on those moves in this node.
  */
 struct DefensiveSet {
-    bool isLost = false;            ///< True iff no defense exists; node is lost.
-    std::vector<Move> defensiveMoves; ///< Moves that defend against all found sequences.
-};
-
-// -----------------------------------------------------------------------------
-// Search-time limits / configuration
-// -----------------------------------------------------------------------------
-
-/**
- * @brief Limits and optional abort flag for a single threat search call.
- */
-struct ThreatSearchLimits {
-    /// Maximum number of internal nodes (threat/combo nodes) to explore.
-    int maxNodes = 200000;
-
-    /// Maximum logical depth (number of threat layers).
-    int maxDepth = 20;
-
-    /// Optional external abort flag (owned by caller). If non-null and set
-    /// to true during search, the solver will stop early and return “no info”.
-    const bool* abortFlag = nullptr;
+    bool isLost = false;                ///< True iff no defense exists; node is lost.
+    DefensiveMoveList defensiveMoves;   ///< Moves that defend against all found sequences.
 };
 
 // -----------------------------------------------------------------------------
@@ -176,7 +197,9 @@ struct ThreatSearchLimits {
  *   }
  *
  * You can keep one ThreatSolver per root position and keep it in sync via
- * syncFromBoard() or the incremental onRootMove*() notifications.
+ * syncFromBoard() or the incremental notifyMove()/notifyUndo() notifications.
+ * Copies share the analyzeThreats() cache, so per-thread copies of one
+ * solver reuse each other's results.
  */
 class ThreatSolver : public IThreatSolver {
 public:
@@ -187,8 +210,9 @@ public:
     /**
      * @brief Construct a solver from an initial board position.
      *
-     * Builds all internal data structures (rotated bitboards, threat board, etc.)
-     * from the given Board.
+     * Builds all internal data structures (threat board, etc.) from the given
+     * Board. Line contents are read directly from the Board's incrementally
+     * maintained line bitboards, so no rotated copy is kept here.
      *
      * @param board Current root position. Reference stored; Board must outlive this ThreatSolver.
      */
@@ -226,46 +250,49 @@ public:
 
     
     // --- [NEW] Interface Implementation ---
-    
-    // This acts as an adapter. It calls the detailed methods below 
-    // and populates the generic ThreatAnalysis struct.
+
+    /**
+     * @brief Adapter for IThreatSolver: forced-win search for @p attacker plus
+     *        the defensive set of the other side.
+     *
+     * The defensive set is built from the winning sequence the first search
+     * found, so the attacker's position is searched once; without a win it
+     * is empty.
+     *
+     * Results are cached by (board hash, attacker) in a ThreatCache shared
+     * by all copies of this solver; a cached result is reused only if it was
+     * computed with at least @p limits.maxNodes nodes.  If @p board is not
+     * the solver's current root, the solver is re-synced to it first.
+     */
+    ThreatAnalysis analyzeThreats(const Board& board, Player attacker,
+                                  const ThreatSearchLimits& limits) override;
+
     ThreatAnalysis analyzeThreats(const Board& board, Player attacker) override {
-        ThreatAnalysis result;
-        
-        // 1. Check for Forced Win
-        ThreatSequence winningSeq;
-        // Use default limits or configure via member variables if needed
-        if (findWinningThreatSequence(attacker, winningSeq)) {
-            result.attackerHasForcedWin = true;
-            if (!winningSeq.attackerMoves.empty()) {
-                result.firstWinningMove = winningSeq.attackerMoves.front();
-            }
-            result.winningLine = winningSeq.attackerMoves;
-        }
-
-        // 2. Compute Defenses (if opponent is attacking, or general safety)
-        // Note: In SearchEngine, we usually call analyzeThreats(board, sideToMove)
-        // to see if *we* win, and analyzeThreats(board, opponent) to see if *they* win.
-        
-        // If we found a win for 'attacker', the 'defensiveMoves' field implies 
-        // moves that the *defender* could play to stop it.
-        // However, your computeDefensiveSet API asks for "defender" perspective.
-        Player defender = (attacker == Player::Black) ? Player::White : Player::Black;
-        
-        // We only strictly need defensive set if the opponent (attacker) has a threat.
-        // But for completeness, we can query it.
-        DefensiveSet ds = computeDefensiveSet(defender);
-        
-        if (ds.isLost) {
-            // Even with optimal play, defender loses.
-            result.defensiveMoves.clear(); 
-        } else {
-            result.defensiveMoves = ds.defensiveMoves;
-        }
-
-        return result;
+        return analyzeThreats(board, attacker, ThreatSearchLimits{});
     }
 
+    ThreatCacheStats cacheStats() const override;
+
+    /**
+     * @brief Prove or refute every root move in parallel.
+     *
+     * The moves are handed out to @p threads workers (the calling thread
+     * is one of them), each with its own Board copy and solver copy sharing
+     * the cache.  After move m, the opponent's forced win proves a Loss; a
+     * five, or an opponent that has no defense left (computeDefensiveSet()
+     * isLost), proves a Win.  The first Win cancels the remaining work
+     * through an internal abort flag.  The caller's @p limits.abortFlag
+     * stops the searches in flight as well (it is passed on next to the
+     * internal flag, in ThreatSearchLimits::extraAbortFlag).
+     */
+    RootProofResult proveRootMoves(const Board& board, const MoveList& moves,
+                                   int threads, const ThreatSearchLimits& limits) override;
+
+    /**
+     * @brief Copy of this solver synced to @p board; shares the cache.
+     */
+    std::unique_ptr<IThreatSolver> clone(const Board& board) const override;
+
     // -------------------------------------------------------------------------
     // Main threat sequence queries
     // -------------------------------------------------------------------------
@@ -334,12 +361,26 @@ public:
      * - OpenThree
      * - BrokenThree
      *
+     * Moves that make a Five or an OpenFour are reported as well.  Each
+     * entry is the threat created by playing its gainSquare; one entry per
+     * (move, direction).
+     *
      * @param attacker Player for whom to collect threats.
      * @param out      Vector that will be appended with all current forcing threats.
      */
     void collectCurrentForcingThreats(Player attacker,
                                       std::vector<ThreatInstance>& out) const;
 
+    /**
+     * @brief Adapter for IThreatSolver: the moves that make a five, a four
+     *        or a three for @p attacker, read from the threat board.
+     *
+     * O(board) cell reads, no threat search.  If @p board is not the
+     * solver's current root, the solver is re-synced to it first.
+     */
+    bool collectForcingMoves(const Board& board, Player attacker,
+                             ForcingMoves& out) override;
+
     /**
      * @brief Get the threat type available to @p attacker at @p move in one direction.
      *
@@ -0,0 +1,138 @@
+// analysis_service.cpp
+// AnalysisService: a worker pool of long-lived engines for batch analysis.
+
+#include "analysis_service.h"
+
+#include "search_engine.h"
+#include "search/evaluator.h"
+#include "search/history_heuristic.h"
+#include "tactics/threat_solver.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace gomoku {
+
+// One worker: an engine bound to its own board, reused for every job.
+struct AnalysisService::Worker {
+    explicit Worker(std::size_t ttSizeMB)
+        : evaluator(board),
+          threats(board),
+          engine(board, evaluator, &threats, &history) {
+        engine.setHashSizeMB(ttSizeMB);
+    }
+
+    Board            board;
+    PatternEvaluator evaluator;
+    ThreatSolver     threats;
+    HistoryHeuristic history;
+    SearchEngine     engine;
+    std::thread      thread;
+};
+
+AnalysisService::AnalysisService(int            workers,
+                                 ResultCallback onResult,
+                                 std::size_t    ttSizeMB,
+                                 std::size_t    maxBacklog)
+    : onResult_(std::move(onResult)) {
+    const int count = std::max(1, workers);
+    maxBacklog_ = maxBacklog ? maxBacklog : 4 * static_cast<std::size_t>(count);
+    for (int i = 0; i < count; ++i) workers_.emplace_back(new Worker(ttSizeMB));
+    for (auto& w : workers_) {
+        Worker* worker = w.get();
+        w->thread = std::thread([this, worker] { workerLoop(*worker); });
+    }
+}
+
+AnalysisService::~AnalysisService() {
+    finish();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shutdown_ = true;
+    }
+    jobReady_.notify_all();
+    for (auto& w : workers_) {
+        if (w->thread.joinable()) w->thread.join();
+    }
+}
+
+std::size_t AnalysisService::submit(AnalysisJob job) {
+    std::size_t index;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        progress_.wait(lock, [this] { return submitted_ - delivered_ < maxBacklog_; });
+        index = submitted_++;
+        queue_.push_back(Pending{index, std::move(job)});
+    }
+    jobReady_.notify_one();
+    return index;
+}
+
+void AnalysisService::finish() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    progress_.wait(lock, [this] { return delivered_ == submitted_; });
+}
+
+void AnalysisService::workerLoop(Worker& worker) {
+    for (;;) {
+        Pending pending;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            jobReady_.wait(lock, [this] { return shutdown_ || !queue_.empty(); });
+            if (queue_.empty()) return;
+            pending = std::move(queue_.front());
+            queue_.pop_front();
+        }
+
+        // The positions are unrelated: new root, no history.  The table is
+        // kept (and aged by the search).
+        worker.board = pending.job.board;
+        worker.threats.syncFromBoard(worker.board);
+        worker.history.clear();
+        SearchLimits limits = pending.job.limits;
+        limits.ttSizeMB = 0;
+
+        AnalysisResult result;
+        result.id     = pending.job.id;
+        result.index  = pending.index;
+        result.result = worker.engine.searchBestMove(limits);
+        complete(std::move(result));
+    }
+}
+
+void AnalysisService::complete(AnalysisResult result) {
+    std::size_t delivered = 0;
+    {
+        std::lock_guard<std::mutex> lock(deliverMutex_);
+        const std::size_t index = result.index;
+        finished_.emplace(index, std::move(result));
+        while (!finished_.empty() && finished_.begin()->first == nextToDeliver_) {
+            if (onResult_) onResult_(finished_.begin()->second);
+            finished_.erase(finished_.begin());
+            ++nextToDeliver_;
+            ++delivered;
+        }
+    }
+    if (delivered == 0) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        delivered_ += delivered;
+    }
+    progress_.notify_all();
+}
+
+std::vector<AnalysisResult> AnalysisService::analyzeAll(const std::vector<AnalysisJob>& jobs,
+                                                        int workers,
+                                                        std::size_t ttSizeMB) {
+    std::vector<AnalysisResult> results(jobs.size());
+    {
+        AnalysisService service(workers,
+                                [&results](const AnalysisResult& r) { results[r.index] = r; },
+                                ttSizeMB);
+        for (const AnalysisJob& job : jobs) service.submit(job);
+        service.finish();
+    }
+    return results;
+}
+
+} // namespace gomoku
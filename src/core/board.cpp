@@ -1,4 +1,6 @@
 #include "board.h"
+#include "bit_utils.h"
+#include <cassert>
 #include <cstring>
 #include <random>
 
@@ -18,6 +20,7 @@ namespace gomoku {
 bool Board::zobristInitialized = false;
 uint64_t Board::zobristTable[12][12][2];
 uint64_t Board::zobristSide = 0ULL;
+uint64_t Board::symmetryZobrist[Board::kNumSymmetries][2][144];
 //Helper functions
 
 //Inspect current side
@@ -29,7 +32,7 @@ Player Board::getSideToMove() const {
 void Board::setSideToMove(Player p) {
     if (side_to_move != p) {
         // Toggling side_to_move must toggle the zobristSide flag exactly once.
-        hashKey ^= zobristSide;
+        toggleSideHash();
         side_to_move = p;
     }
 }
@@ -47,7 +50,9 @@ bool Board::placeStone(int x, int y, Player player) {
     int p   = static_cast<int>(player);
 
     bb[p][c] |= (1ULL << off);
-    hashKey ^= zobristTable[x][y][p];   // update piece hash only
+    toggleLineBits(p, x, y);
+    adjustNeighbours(x, y, +1);
+    toggleStoneHash(p, x, y);   // update piece hash only
 
     // NOTE: we do NOT touch side_to_move or zobristSide here.
     return true;
@@ -68,7 +73,9 @@ bool Board::removeStone(int x, int y, Player player) {
     }
 
     bb[p][c] &= ~mask;
-    hashKey ^= zobristTable[x][y][p];   // remove piece from hash
+    toggleLineBits(p, x, y);
+    adjustNeighbours(x, y, -1);
+    toggleStoneHash(p, x, y);   // remove piece from hash
 
     // NOTE: no side_to_move / zobristSide change.
     return true;
@@ -77,9 +84,12 @@ bool Board::removeStone(int x, int y, Player player) {
 Board::Board() : side_to_move(Player::Black) {
     // Ensure Zobrist tables are initialized before using them.
     initZobrist();
-    // Initialize bitboards to zero and hashKey to zero.
+    // Initialize bitboards to zero and the hash keys to zero.
     std::memset(bb, 0, sizeof(bb));
-    hashKey = 0ULL;
+    std::memset(lines, 0, sizeof(lines));
+    std::memset(neighbourCount, 0, sizeof(neighbourCount));
+    std::memset(nearStones, 0, sizeof(nearStones));
+    std::memset(hashKeys, 0, sizeof(hashKeys));
 
     // Starting position: white at (6,6) and (5,5),
     // black at (6,5) and (5,6).
@@ -91,8 +101,10 @@ Board::Board() : side_to_move(Player::Black) {
             int c = chunkOf(idx);
             int off = offsetOf(idx);
             bb[static_cast<int>(Player::White)][c] |= (1ULL << off);
+            toggleLineBits(static_cast<int>(Player::White), p[0], p[1]);
+            adjustNeighbours(p[0], p[1], +1);
             // Update hash for white stone at (x,y).
-            hashKey ^= zobristTable[p[0]][p[1]][static_cast<int>(Player::White)];
+            toggleStoneHash(static_cast<int>(Player::White), p[0], p[1]);
         }
     }
     // Place black stones and update hash.
@@ -103,14 +115,34 @@ Board::Board() : side_to_move(Player::Black) {
             int c = chunkOf(idx);
             int off = offsetOf(idx);
             bb[static_cast<int>(Player::Black)][c] |= (1ULL << off);
+            toggleLineBits(static_cast<int>(Player::Black), p[0], p[1]);
+            adjustNeighbours(p[0], p[1], +1);
             // Update hash for black stone at (x,y).
-            hashKey ^= zobristTable[p[0]][p[1]][static_cast<int>(Player::Black)];
+            toggleStoneHash(static_cast<int>(Player::Black), p[0], p[1]);
         }
     }
     // It is black's turn to move by convention; no need to toggle side marker.
     side_to_move = Player::Black;
 }
 
+void Board::toggleStoneHash(int p, int x, int y) {
+    const int idx = index(x, y);
+    for (int s = 0; s < kNumSymmetries; ++s) hashKeys[s] ^= symmetryZobrist[s][p][idx];
+}
+
+void Board::toggleSideHash() {
+    for (uint64_t& k : hashKeys) k ^= zobristSide;
+}
+
+uint64_t Board::getCanonicalKey(int* symmetry) const {
+    int best = 0;
+    for (int s = 1; s < kNumSymmetries; ++s) {
+        if (hashKeys[s] < hashKeys[best]) best = s;
+    }
+    if (symmetry) *symmetry = best;
+    return hashKeys[best];
+}
+
 bool Board::isOccupied(int x, int y) const {
     if (x < 0 || x >= 12 || y < 0 || y >= 12) return true;
     int idx = index(x, y);
@@ -139,6 +171,14 @@ void Board::initZobrist() {
         }
     }
     zobristSide = rng();
+    for (int s = 0; s < kNumSymmetries; ++s) {
+        for (int idx = 0; idx < 144; ++idx) {
+            const Move t = transformMove(s, Move(idx % 12, idx / 12));
+            for (int p = 0; p < 2; ++p) {
+                symmetryZobrist[s][p][idx] = zobristTable[t.x][t.y][p];
+            }
+        }
+    }
     zobristInitialized = true;
 }
 
@@ -157,15 +197,17 @@ bool Board::makeMove(int x, int y) {
     int playerIndex = static_cast<int>(side_to_move);
     // Set the bit in the current player's bitboard.
     bb[playerIndex][c] |= (1ULL << off);
+    toggleLineBits(playerIndex, x, y);
+    adjustNeighbours(x, y, +1);
     // Update the Zobrist hash: XOR the random value associated with this
     // cell and player.  Toggling a bit on or off is achieved by XORing
     // the same value in makeMove and unmakeMove.
-    hashKey ^= zobristTable[x][y][playerIndex];
+    toggleStoneHash(playerIndex, x, y);
     // Toggle side_to_move and update the side marker in the hash.  The side
     // marker ensures that the same board position with different players to
     // move yields a different hash key.
     side_to_move = (side_to_move == Player::Black) ? Player::White : Player::Black;
-    hashKey ^= zobristSide;
+    toggleSideHash();
     return true;
 }
 
@@ -173,7 +215,7 @@ bool Board::unmakeMove(int x, int y) {
     // Restore side_to_move by toggling it back and updating the side
     // marker in the hash.  This is the reverse operation of makeMove().
     side_to_move = (side_to_move == Player::Black) ? Player::White : Player::Black;
-    hashKey ^= zobristSide;
+    toggleSideHash();
     // Locate the stone's bit in the bitboard.
     int idx  = index(x, y);
     int c    = chunkOf(idx);
@@ -182,148 +224,288 @@ bool Board::unmakeMove(int x, int y) {
     int p    = static_cast<int>(side_to_move);
     // Clear the bit from the appropriate player's bitboard.
     bb[p][c] &= ~mask;
+    toggleLineBits(p, x, y);
+    adjustNeighbours(x, y, -1);
     // XOR the corresponding random number to remove the stone from the hash.
-    hashKey ^= zobristTable[x][y][p];
+    toggleStoneHash(p, x, y);
     return true;
 }
 
-bool Board::checkWin(Player player) const {
-    int p = static_cast<int>(player);
-    // Iterate over every occupied cell of player p.  For each stone we
-    // attempt to count contiguous stones in four directions.  As soon as
-    // we find a line of length ≥ 5 we can declare a win.
-    for (int y = 0; y < 12; ++y) {
-        for (int x = 0; x < 12; ++x) {
-            int idx = index(x, y);
-            int c   = chunkOf(idx);
-            int off = offsetOf(idx);
-            // Skip if this cell does not contain a stone of player p.
-            if ((bb[p][c] & (1ULL << off)) == 0ULL) {
-                continue;
-            }
-            // For each stone, check four directions: horizontal (1,0),
-            // vertical (0,1), diagonal down‑right (1,1) and diagonal
-            // up‑right (1,−1).  We count contiguous stones in both
-            // directions and sum the lengths.
-            const int dirs[4][2] = {
-                {1, 0},  // horizontal
-                {0, 1},  // vertical
-                {1, 1},  // diagonal down‑right
-                {1, -1}  // diagonal up‑right
-            };
-            for (int d = 0; d < 4; ++d) {
-                int dx = dirs[d][0];
-                int dy = dirs[d][1];
-                int count = 1;
-                // Extend forward in direction (dx,dy).
-                int nx = x + dx;
-                int ny = y + dy;
-                while (nx >= 0 && nx < 12 && ny >= 0 && ny < 12) {
-                    int nidx = index(nx, ny);
-                    int nc   = chunkOf(nidx);
-                    int no   = offsetOf(nidx);
-                    if ((bb[p][nc] & (1ULL << no)) == 0ULL) break;
-                    ++count;
-                    nx += dx;
-                    ny += dy;
-                }
-                // Extend backward in direction (−dx,−dy).
-                nx = x - dx;
-                ny = y - dy;
-                while (nx >= 0 && nx < 12 && ny >= 0 && ny < 12) {
-                    int nidx = index(nx, ny);
-                    int nc   = chunkOf(nidx);
-                    int no   = offsetOf(nidx);
-                    if ((bb[p][nc] & (1ULL << no)) == 0ULL) break;
-                    ++count;
-                    nx -= dx;
-                    ny -= dy;
-                }
-                // If the total count reaches 5 or more, this player wins.
-                if (count >= 5) return true;
-            }
-        }
-    }
-    return false;
+void Board::makeNullMove() {
+    side_to_move = (side_to_move == Player::Black) ? Player::White : Player::Black;
+    toggleSideHash();
 }
 
-std::vector<Move> Board::getLegalMoves() const {
-    std::vector<Move> moves;
-    moves.reserve(144);
-    for (int y = 0; y < 12; ++y) {
-        for (int x = 0; x < 12; ++x) {
-            if (!isOccupied(x, y)) {
-                moves.emplace_back(x, y);
+void Board::unmakeNullMove() {
+    // Passing is its own inverse.
+    makeNullMove();
+}
+
+namespace {
+
+// Shift a 144-bit bitboard (three 64-bit chunks) towards lower indices, so
+// that bit i of the result is bit i+s of the input.  Valid for 0 < s < 64.
+inline void shiftDown(const uint64_t in[3], int s, uint64_t out[3]) {
+    out[0] = (in[0] >> s) | (in[1] << (64 - s));
+    out[1] = (in[1] >> s) | (in[2] << (64 - s));
+    out[2] = in[2] >> s;
+}
+
+// True if the line mask contains five consecutive set bits.
+inline bool hasFive(uint32_t line) {
+    return (line & (line >> 1) & (line >> 2) & (line >> 3) & (line >> 4)) != 0U;
+}
+
+// For each of the four directions, the bit step between neighbouring cells
+// on a line and the set of cells from which a five can start without running
+// off the board (which would otherwise wrap into the next row).
+struct FiveStartMasks {
+    int      step[4];
+    uint64_t mask[4][3];
+
+    FiveStartMasks() : step{1, 12, 13, 11}, mask{} {
+        for (int y = 0; y < 12; ++y) {
+            for (int x = 0; x < 12; ++x) {
+                int idx = y * 12 + x;
+                uint64_t bit = 1ULL << (idx & 63);
+                if (x <= 7)            mask[0][idx >> 6] |= bit; // horizontal
+                if (y <= 7)            mask[1][idx >> 6] |= bit; // vertical
+                if (x <= 7 && y <= 7)  mask[2][idx >> 6] |= bit; // down-right
+                if (x >= 4 && y <= 7)  mask[3][idx >> 6] |= bit; // down-left
             }
         }
     }
-    return moves;
+};
+
+const FiveStartMasks kFiveStarts;
+
+// Shift towards higher indices: bit i+s of the result is bit i of the input.
+// Valid for 0 < s < 64; bits pushed past index 143 must be masked off.
+inline void shiftUp(const uint64_t in[3], int s, uint64_t out[3]) {
+    out[2] = (in[2] << s) | (in[1] >> (64 - s));
+    out[1] = (in[1] << s) | (in[0] >> (64 - s));
+    out[0] = in[0] << s;
 }
 
-std::vector<Move> Board::getCandidateMoves() const {
-    std::vector<Move> moves;
-    // Compute a minimal axis‑aligned bounding box around all existing stones.
-    int min_x = 12, max_x = -1, min_y = 12, max_y = -1;
-    bool found = false;
-    for (int y = 0; y < 12; ++y) {
-        for (int x = 0; x < 12; ++x) {
-            if (isOccupied(x, y)) {
-                found = true;
-                if (x < min_x) min_x = x;
-                if (x > max_x) max_x = x;
-                if (y < min_y) min_y = y;
-                if (y > max_y) max_y = y;
-            }
+// Column masks that stop horizontal and diagonal shifts from wrapping into
+// the neighbouring row, plus the 144 valid cells.
+struct DilationMasks {
+    uint64_t notFirstCol[3];  // x != 0
+    uint64_t notLastCol[3];   // x != 11
+    uint64_t onBoard[3];
+
+    DilationMasks() : notFirstCol{}, notLastCol{}, onBoard{} {
+        for (int idx = 0; idx < 144; ++idx) {
+            uint64_t bit = 1ULL << (idx & 63);
+            int x = idx % 12;
+            if (x != 0)  notFirstCol[idx >> 6] |= bit;
+            if (x != 11) notLastCol[idx >> 6]  |= bit;
+            onBoard[idx >> 6] |= bit;
         }
     }
-    if (!found) {
+};
+
+const DilationMasks kDilation;
+
+// Add the 8 neighbours of every set cell (one step of king-move dilation).
+inline void dilate(uint64_t bits[3]) {
+    uint64_t left[3], right[3];  // sources allowed to step -x / +x
+    for (int c = 0; c < 3; ++c) {
+        left[c]  = bits[c] & kDilation.notFirstCol[c];
+        right[c] = bits[c] & kDilation.notLastCol[c];
+    }
+    uint64_t acc[3] = {bits[0], bits[1], bits[2]};
+    uint64_t t[3];
+    // Steps: ±1 horizontal, ±12 vertical, ±13 and ±11 diagonal.
+    shiftUp(right, 1, t);    for (int c = 0; c < 3; ++c) acc[c] |= t[c];
+    shiftDown(left, 1, t);   for (int c = 0; c < 3; ++c) acc[c] |= t[c];
+    shiftUp(bits, 12, t);    for (int c = 0; c < 3; ++c) acc[c] |= t[c];
+    shiftDown(bits, 12, t);  for (int c = 0; c < 3; ++c) acc[c] |= t[c];
+    shiftUp(right, 13, t);   for (int c = 0; c < 3; ++c) acc[c] |= t[c];
+    shiftDown(left, 13, t);  for (int c = 0; c < 3; ++c) acc[c] |= t[c];
+    shiftUp(left, 11, t);    for (int c = 0; c < 3; ++c) acc[c] |= t[c];
+    shiftDown(right, 11, t); for (int c = 0; c < 3; ++c) acc[c] |= t[c];
+    for (int c = 0; c < 3; ++c) bits[c] = acc[c] & kDilation.onBoard[c];
+}
+
+} // namespace
+
+void Board::getCandidateMoves(MoveList& out, int radius) const {
+    out.clear();
+    uint64_t occupied[3] = {
+        bb[0][0] | bb[1][0], bb[0][1] | bb[1][1], bb[0][2] | bb[1][2]
+    };
+    if ((occupied[0] | occupied[1] | occupied[2]) == 0ULL) {
         // No stones on the board: play in the centre.  On a 12×12 board the
         // true centre is (5,5) (zero‑indexed).  We return only this move
         // since all other moves are equivalent by symmetry.
-        moves.emplace_back(5, 5);
-        return moves;
+        out.push_back(Move(5, 5));
+        return;
     }
-    // Expand the bounding box by a margin of two cells in all directions.
-    // This focuses search near the existing stones but allows for tactical
-    // moves slightly away from the cluster.  Clamp the box to the board.
-    min_x = std::max(0, min_x - 2);
-    min_y = std::max(0, min_y - 2);
-    max_x = std::min(11, max_x + 2);
-    max_y = std::min(11, max_y + 2);
-    for (int y = min_y; y <= max_y; ++y) {
-        for (int x = min_x; x <= max_x; ++x) {
-            if (!isOccupied(x, y)) {
-                bool neighbor = false;
-                // Only keep cells that have at least one adjacent stone.
-                // Moves far from existing stones are unlikely to matter in
-                // practice and can be ignored to reduce the branching factor.
-                for (int dy = -1; dy <= 1 && !neighbor; ++dy) {
-                    for (int dx = -1; dx <= 1 && !neighbor; ++dx) {
-                        if (dx == 0 && dy == 0) continue;
-                        int nx = x + dx;
-                        int ny = y + dy;
-                        if (nx >= 0 && nx < 12 && ny >= 0 && ny < 12) {
-                            if (isOccupied(nx, ny)) {
-                                neighbor = true;
-                            }
-                        }
-                    }
-                }
-                if (neighbor) {
-                    moves.emplace_back(x, y);
-                }
-            }
+    // Cells within 'radius' king steps of a stone, minus the stones.  The
+    // radius-1 set is maintained incrementally (nearStones); wider radii
+    // dilate it further.
+    uint64_t near[3] = {nearStones[0], nearStones[1], nearStones[2]};
+    for (int r = 1; r < radius; ++r) dilate(near);
+    uint64_t empty[3];
+    for (int c = 0; c < 3; ++c) {
+        empty[c] = ~occupied[c] & kDilation.onBoard[c];
+        near[c] &= empty[c];
+    }
+    auto emit = [&out](int idx) { out.push_back(Move(idx % 12, idx / 12)); };
+    forEachSetBit(near, emit);
+    // Rare case: a full neighbourhood (nothing empty near the stones) still
+    // has to give the engine something to search.
+    if (out.empty()) forEachSetBit(empty, emit);
+}
+
+std::vector<Move> Board::getCandidateMoves() const {
+    MoveList list;
+    getCandidateMoves(list);
+    return std::vector<Move>(list.begin(), list.end());
+}
+
+bool Board::checkWin(Player player) const {
+    const uint64_t* stones = bb[static_cast<int>(player)];
+    // For each direction, AND the bitboard with itself shifted by 1..4 steps
+    // along that direction.  A surviving bit marks the first stone of a five.
+    for (int d = 0; d < 4; ++d) {
+        int step = kFiveStarts.step[d];
+        uint64_t acc[3] = {
+            stones[0] & kFiveStarts.mask[d][0],
+            stones[1] & kFiveStarts.mask[d][1],
+            stones[2] & kFiveStarts.mask[d][2]
+        };
+        for (int k = 1; k <= 4 && (acc[0] | acc[1] | acc[2]) != 0ULL; ++k) {
+            uint64_t shifted[3];
+            shiftDown(stones, k * step, shifted);
+            acc[0] &= shifted[0];
+            acc[1] &= shifted[1];
+            acc[2] &= shifted[2];
+        }
+        if ((acc[0] | acc[1] | acc[2]) != 0ULL) return true;
+    }
+    return false;
+}
+
+void Board::toggleLineBits(int p, int x, int y) {
+    for (int d = 0; d < kNumDirections; ++d) {
+        lines[p][d][lineIdOf(d, x, y)] ^=
+            static_cast<uint16_t>(1U << lineOffsetOf(d, x, y));
+    }
+}
+
+void Board::adjustNeighbours(int x, int y, int delta) {
+    for (int dy = -1; dy <= 1; ++dy) {
+        for (int dx = -1; dx <= 1; ++dx) {
+            int nx = x + dx;
+            int ny = y + dy;
+            if ((dx == 0 && dy == 0) || nx < 0 || nx >= 12 || ny < 0 || ny >= 12) continue;
+            int idx = index(nx, ny);
+            neighbourCount[idx] = static_cast<uint8_t>(neighbourCount[idx] + delta);
+            uint64_t bit = 1ULL << offsetOf(idx);
+            if (neighbourCount[idx] != 0) nearStones[chunkOf(idx)] |= bit;
+            else                          nearStones[chunkOf(idx)] &= ~bit;
         }
     }
-    // Rare case: if the bounding box produced no moves (e.g. stones are
-    // isolated with margin=2), fall back to all legal moves.  This ensures
-    // that the engine always has moves to consider.
-    if (moves.empty()) {
-        return getLegalMoves();
+}
+
+uint32_t Board::lineWindow(int p, int dir, int x, int y) const {
+    // Re-centre the line on (x,y) and keep offsets -4..+4.
+    uint32_t line = lines[p][dir][lineIdOf(dir, x, y)];
+    return ((line << 4) >> lineOffsetOf(dir, x, y)) & 0x1FFU;
+}
+
+bool Board::checkWinAt(int x, int y) const {
+    int state = getCellState(x, y);
+    if (state <= 0) return false;
+    int p = state - 1;
+    for (int d = 0; d < kNumDirections; ++d) {
+        if (hasFive(lineWindow(p, d, x, y))) return true;
+    }
+    return false;
+}
+
+bool Board::isWinningMove(int x, int y, Player player) const {
+    if (isOccupied(x, y)) return false;
+    int p = static_cast<int>(player);
+    // Pretend the stone is there by setting the centre bit of each window.
+    const uint32_t centre = 1U << 4;
+    for (int d = 0; d < kNumDirections; ++d) {
+        if (hasFive(lineWindow(p, d, x, y) | centre)) return true;
     }
+    return false;
+}
+
+std::vector<Move> Board::getLegalMoves() const {
+    const EmptyCells empty = emptyCells();
+    std::vector<Move> moves;
+    moves.reserve(static_cast<std::size_t>(empty.size()));
+    for (const Move& m : empty) moves.push_back(m);
     return moves;
 }
 
+EmptyCells Board::emptyCells() const {
+    uint64_t empty[3];
+    for (int c = 0; c < 3; ++c) {
+        empty[c] = ~(bb[0][c] | bb[1][c]);
+    }
+    empty[2] &= (1ULL << (144 - 128)) - 1ULL;
+    return EmptyCells(empty);
+}
+
+BoardState Board::snapshot() const {
+    BoardState s;
+    for (int p = 0; p < 2; ++p) {
+        for (int c = 0; c < 3; ++c) s.stones[p][c] = bb[p][c];
+    }
+    if (side_to_move == Player::White) s.stones[1][2] |= BoardState::kSideBit;
+    s.hash = hashKeys[0];
+    return s;
+}
+
+bool Board::restore(const BoardState& state) {
+    const uint64_t cellMask[3] = {~0ULL, ~0ULL, (1ULL << (144 - 128)) - 1ULL};
+    uint64_t target[2][3];
+    for (int c = 0; c < 3; ++c) {
+        target[0][c] = state.stones[0][c];
+        target[1][c] = state.stones[1][c] & (c == 2 ? ~BoardState::kSideBit : ~0ULL);
+        if (((target[0][c] | target[1][c]) & ~cellMask[c]) != 0ULL) return false;
+        if ((target[0][c] & target[1][c]) != 0ULL) return false;
+    }
+
+    // Removals first, so a cell that changes colour is empty in between.
+    for (int p = 0; p < 2; ++p) {
+        uint64_t gone[3];
+        for (int c = 0; c < 3; ++c) gone[c] = bb[p][c] & ~target[p][c];
+        forEachSetBit(gone, [this, p](int idx) {
+            removeStone(idx % 12, idx / 12, static_cast<Player>(p));
+        });
+    }
+    for (int p = 0; p < 2; ++p) {
+        uint64_t added[3];
+        for (int c = 0; c < 3; ++c) added[c] = target[p][c] & ~bb[p][c];
+        forEachSetBit(added, [this, p](int idx) {
+            placeStone(idx % 12, idx / 12, static_cast<Player>(p));
+        });
+    }
+    setSideToMove(state.sideToMove());
+    assert(hashKeys[0] == state.hash && "BoardState::hash does not match its stones");
+    return true;
+}
+
+uint64_t Board::hashOf(const BoardState& state) {
+    initZobrist();
+    uint64_t key = 0ULL;
+    for (int p = 0; p < 2; ++p) {
+        const uint64_t stones[3] = {state.stones[p][0], state.stones[p][1],
+                                    state.stones[p][2] & ((1ULL << (144 - 128)) - 1ULL)};
+        forEachSetBit(stones, [&key, p](int idx) { key ^= symmetryZobrist[0][p][idx]; });
+    }
+    if (state.sideToMove() == Player::White) key ^= zobristSide;
+    return key;
+}
+
 int Board::getCellState(int x, int y) const {
     if (x < 0 || x >= 12 || y < 0 || y >= 12) return -1;
     int idx = index(x, y);
@@ -342,18 +524,6 @@ int Board::getCellState(int x, int y) const {
 int Board::countStones(Player player) const {
     int p = static_cast<int>(player);
     int total = 0;
-    // Use a portable popcount implementation to avoid relying on compiler
-    // built‑ins that might not be available on all compilers.  Brian
-    // Kernighan’s algorithm counts the number of set bits in a 64‑bit
-    // integer by repeatedly clearing the least significant set bit.
-    auto popcount64 = [](uint64_t x) {
-        int cnt = 0;
-        while (x) {
-            x &= (x - 1);
-            ++cnt;
-        }
-        return cnt;
-    };
     for (int c = 0; c < 3; ++c) {
         total += popcount64(bb[p][c]);
     }
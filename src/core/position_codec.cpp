@@ -0,0 +1,70 @@
+// position_codec.cpp
+// Packed and move-list position formats.
+
+#include "core/position_codec.h"
+
+#include <cctype>
+
+namespace gomoku {
+
+namespace {
+
+constexpr int kPlaneBytes = 144 / 8;
+
+} // namespace
+
+// The packed planes are the low 144 bits of the bitboards in little-endian
+// byte order, independent of the host's.
+void packPosition(const Board& board, unsigned char out[kPackedPositionSize]) {
+    const BoardState state = board.snapshot();
+    for (int p = 0; p < 2; ++p) {
+        for (int b = 0; b < kPlaneBytes; ++b) {
+            const uint64_t chunk = state.stones[p][b / 8];
+            out[p * kPlaneBytes + b] = static_cast<unsigned char>(chunk >> (8 * (b % 8)));
+        }
+    }
+    out[2 * kPlaneBytes] = state.sideToMove() == Player::Black ? 0 : 1;
+}
+
+bool unpackPosition(const unsigned char* in, Board& out) {
+    const unsigned char side = in[2 * kPlaneBytes];
+    if (side > 1) return false;
+    BoardState state = {};
+    for (int p = 0; p < 2; ++p) {
+        for (int b = 0; b < kPlaneBytes; ++b) {
+            state.stones[p][b / 8] |= static_cast<uint64_t>(in[p * kPlaneBytes + b]) << (8 * (b % 8));
+        }
+    }
+    if (side == 1) state.stones[1][2] |= BoardState::kSideBit;
+    state.hash = Board::hashOf(state);
+    return out.restore(state);
+}
+
+bool parseMoveList(const std::string& text, Board& out) {
+    out = Board();
+    std::size_t i = 0;
+    const std::size_t n = text.size();
+    for (;;) {
+        while (i < n && (std::isspace(static_cast<unsigned char>(text[i])) || text[i] == ',')) ++i;
+        if (i == n) return true;
+
+        const char column = static_cast<char>(std::tolower(static_cast<unsigned char>(text[i++])));
+        if (column < 'a' || column > 'l') return false;
+        int row = 0;
+        int digits = 0;
+        while (i < n && std::isdigit(static_cast<unsigned char>(text[i])) && digits < 3) {
+            row = row * 10 + (text[i++] - '0');
+            ++digits;
+        }
+        if (digits == 0 || row < 1 || row > 12) return false;
+        if (!out.makeMove(column - 'a', row - 1)) return false;
+    }
+}
+
+std::string cellName(const Move& move) {
+    std::string s(1, static_cast<char>('a' + move.x));
+    s += std::to_string(move.y + 1);
+    return s;
+}
+
+} // namespace gomoku
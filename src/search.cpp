@@ -1 +1,918 @@
-//Empty. Awaits Implementation.
\ No newline at end of file
+// search.cpp
+// SearchEngine: iterative deepening principal variation search.
+//
+// All scores inside the search are from the perspective of rootSideToMove at
+// the start of the search (see search_types.h): nodes where the root side is
+// to move maximise, the others minimise.  Transposition table entries are
+// stored relative to the side to move and converted at the boundary.
+//
+// Per node:
+//   1. Stop check: the stop flag every node, clock and node budget every
+//      TimeManager::kPollInterval nodes.
+//   2. TT probe (cutoffs outside the PV only).
+//   3. Threat analysis for both sides: a proven win for the side to move
+//      ends the node; a winning threat by the opponent restricts the moves
+//      to its defensive set.
+//   4. Null-move pruning when the opponent has no winning threat.
+//   5. PVS over the staged MovePicker (TT move, threat moves, killers and
+//      countermove, history-ordered quiet moves).
+//
+// Search reuse: the TT is aged, not cleared, between moves; history is
+// decayed once per move; and if the game followed the previous PV the
+// iterations start a little below the depth reached last time.
+//
+// Root proofs (optional): when the opponent threatens a forced win, every
+// root move is first proven or refuted by the threat solver; proven losses
+// are removed from the root move list.
+//
+// Instrumentation: GOMOKU_STATS() counters and PhaseTimer scopes
+// (search_stats.h) feed the per-iteration SearchInfo; they compile out with
+// GOMOKU_SEARCH_STATS=0.
+//
+// Lazy SMP: helper threads run the same iterative deepening on private
+// copies of the position; they only interact through the transposition
+// table.  Helper i skips depths following kSkipSize/kSkipPhase so the
+// threads spread over neighbouring depths instead of racing on one.
+
+#include "search_engine.h"
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+namespace gomoku {
+
+namespace {
+
+// Threat-search budget per interior node.  The root uses the solver's
+// default budget.
+constexpr int kNodeThreatBudget = 1000;
+
+// Depth reduction of the null-move search.
+constexpr int kNullMoveReduction = 2;
+
+// Quiet moves per node that get a history penalty when a later move cuts.
+constexpr int kMaxQuietsTracked = 32;
+
+// Quiescence: plies beyond the horizon, and the plies (from the horizon) in
+// which threes are extended as well as fours.
+constexpr int kMaxQuiescencePly   = 8;
+constexpr int kQuiescenceThreePly = 1;
+
+// Iterations below the previous depth reached that are searched again when
+// the game followed the previous PV.
+constexpr int kSeedDepthMargin = 2;
+
+// Depth staggering of helper threads (indexed by (threadIndex - 1) % 20):
+// helper i searches depth d only if (d + phase) / size is even.
+constexpr int kSkipTableSize = 20;
+constexpr int kSkipSize[kSkipTableSize]  = {1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4};
+constexpr int kSkipPhase[kSkipTableSize] = {0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7};
+
+// Sentinel for "no move"; never legal, so MovePicker skips it.
+const Move kNoMove(-1, -1);
+
+// The TT is keyed by Board::getCanonicalKey(), so the eight orientations of
+// a position share one entry; its moves are kept in canonical orientation.
+inline Move toTTMove(const Move& m, int symmetry) {
+    return m == kNoMove ? m : Board::transformMove(symmetry, m);
+}
+
+inline Move fromTTMove(const Move& m, int symmetry) {
+    return m == kNoMove ? m : Board::inverseTransformMove(symmetry, m);
+}
+
+inline Player opponentOf(Player p) {
+    return (p == Player::Black) ? Player::White : Player::Black;
+}
+
+// Score of a win for 'winner' after 'plies' plies from the root, from the
+// root side's perspective.
+inline EvalScore mateScoreFor(Player winner, Player rootSide, int plies) {
+    EvalScore s = kMateScore - plies;
+    return (winner == rootSide) ? s : -s;
+}
+
+// Root-perspective score <-> side-to-move-perspective score.
+inline EvalScore toSideToMove(EvalScore s, bool rootToMove) {
+    return rootToMove ? s : -s;
+}
+
+// Bounds flip with the perspective.
+inline TTNodeType flipBound(TTNodeType t, bool rootToMove) {
+    if (rootToMove || t == TTNodeType::Exact) return t;
+    return (t == TTNodeType::LowerBound) ? TTNodeType::UpperBound : TTNodeType::LowerBound;
+}
+
+} // namespace
+
+// One Lazy SMP helper: a private position plus its own search components.
+struct SearchEngine::HelperThread {
+    explicit HelperThread(const Board& root) : board(root) {}
+
+    Board                              board;
+    std::unique_ptr<IEvaluator>        evaluator;
+    std::unique_ptr<IThreatSolver>     threatSolver;
+    std::unique_ptr<IHistoryHeuristic> history;
+    std::unique_ptr<SearchEngine>      engine;
+    std::thread                        thread;
+};
+
+SearchEngine::SearchEngine(Board&             board,
+                           IEvaluator&        evaluator,
+                           IThreatSolver*     threatSolver,
+                           IHistoryHeuristic* historyHeuristic)
+    : board_(board),
+      evaluator_(evaluator),
+      threatSolver_(threatSolver),
+      history_(historyHeuristic),
+      ownTT_(new TranspositionTable()),
+      tt_(*ownTT_),
+      rootSide_(board.sideToMove()),
+      rootBestMove_(kNoMove),
+      plyBuffers_(kMaxPly) {}
+
+SearchEngine::SearchEngine(Board&              board,
+                           IEvaluator&         evaluator,
+                           IThreatSolver*      threatSolver,
+                           IHistoryHeuristic*  historyHeuristic,
+                           TranspositionTable& tt)
+    : board_(board),
+      evaluator_(evaluator),
+      threatSolver_(threatSolver),
+      history_(historyHeuristic),
+      tt_(tt),
+      rootSide_(board.sideToMove()),
+      rootBestMove_(kNoMove),
+      plyBuffers_(kMaxPly) {}
+
+SearchEngine::~SearchEngine() {
+    stop();
+    joinHelpers();
+}
+
+//------------------------------------------------------------------------------
+// Entry point
+//------------------------------------------------------------------------------
+
+SearchResult SearchEngine::searchBestMove(const SearchLimits& limits) {
+    if (limits.stopToken) limits.stopToken->store(false, std::memory_order_relaxed);
+    if (history_) history_->decay();
+    return runSearch(limits);
+}
+
+SearchResult SearchEngine::runSearch(const SearchLimits& limits) {
+    if (limits.ttSizeMB != 0) tt_.resize(limits.ttSizeMB);
+    tt_.newSearch();
+    threatCacheAtStart_ = threatSolver_ ? threatSolver_->cacheStats() : ThreatCacheStats{};
+    prepareSearch(limits);
+
+    // Fallback so a move is always returned, even if depth 1 does not finish.
+    MoveList candidates;
+    board_.getCandidateMoves(candidates);
+    lastResult_.bestMove = candidates.empty() ? kNoMove : candidates.front();
+    if (!candidates.empty()) startDepth_ = seedFromPreviousSearch();
+
+    bool solved = false;
+    bool timedOut = false;
+    BookMove bookMove;
+    if (book_ && book_->bestMove(board_, bookMove)) {
+        lastResult_.bestMove   = bookMove.move;
+        lastResult_.bestScore  = bookMove.score;  // the book's side to move is rootSide_
+        lastResult_.isBookMove = true;
+        lastResult_.principalVariation.assign(1, bookMove.move);
+        solved = true;
+    }
+    if (!solved && threatSolver_ && !candidates.empty()) {
+        ThreatSearchLimits tl;
+        tl.abortFlag = timeManager_.stopFlag();
+        ThreatAnalysis root = threatSolver_->analyzeThreats(board_, rootSide_, tl);
+        if (root.attackerHasForcedWin && !root.winningLine.empty()) {
+            int plies = 2 * static_cast<int>(root.winningLine.size()) - 1;
+            lastResult_.bestMove    = root.firstWinningMove;
+            lastResult_.bestScore   = mateScoreFor(rootSide_, rootSide_, plies);
+            lastResult_.isMate      = true;
+            lastResult_.isForcedWin = true;
+            lastResult_.principalVariation.assign(root.winningLine.begin(),
+                                                  root.winningLine.end());
+            lastResult_.isProvenWin = confirmWithDfpn(rootSide_);
+            solved = true;
+        } else {
+            const ThreatAnalysis opp = threatSolver_->analyzeThreats(board_, opponentOf(rootSide_), tl);
+            if (opp.attackerHasForcedWin) {
+                timeManager_.onRootDanger();
+                lastResult_.isProvenLoss = confirmWithDfpn(opponentOf(rootSide_));
+                if (limits_.enableRootProofs) solved = proveRootMoves(candidates, opp);
+            }
+        }
+    }
+    if (!solved && !candidates.empty()) {
+        startHelpers();
+        iterativeDeepening(0);
+        timedOut = timeManager_.isStopped();
+        joinHelpers();
+    }
+    timedOut = timedOut || timeManager_.isStopped();
+    timeManager_.requestStop();
+
+    lastResult_.nodes     = nodes_.get();
+    lastResult_.qnodes    = qnodes_.get();
+    lastResult_.hashHits  = hashHits_;
+    lastResult_.isTimeout = timedOut;
+    if (threatSolver_) {
+        ThreatCacheStats now = threatSolver_->cacheStats();
+        threatCacheHits_   = now.hits - threatCacheAtStart_.hits;
+        threatCacheMisses_ = now.misses - threatCacheAtStart_.misses;
+    }
+    lastResult_.threatCacheHits   = threatCacheHits_;
+    lastResult_.threatCacheMisses = threatCacheMisses_;
+    rememberSearch();
+    return lastResult_;
+}
+
+//------------------------------------------------------------------------------
+// Asynchronous search and pondering
+//------------------------------------------------------------------------------
+
+std::future<SearchResult> SearchEngine::startSearch(const SearchLimits& limits,
+                                                    SearchCallback onDone) {
+    stop();
+    SearchLimits l = limits;
+    if (!l.stopToken) l.stopToken = &asyncStop_;
+    asyncStopFlag_ = l.stopToken;
+    asyncStopFlag_->store(false, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(ponderMutex_);
+        stopRequested_ = false;
+        ponderState_   = PonderState::None;
+    }
+
+    if (history_) history_->decay();
+
+    std::promise<SearchResult> promise;
+    std::future<SearchResult> future = promise.get_future();
+    asyncRunning_.store(true, std::memory_order_release);
+    asyncThread_ = std::thread([this, l, onDone, p = std::move(promise)]() mutable {
+        SearchResult r = runSearch(l);
+        if (onDone) onDone(r);
+        asyncRunning_.store(false, std::memory_order_release);
+        p.set_value(r);
+    });
+    return future;
+}
+
+std::future<SearchResult> SearchEngine::startPonder(const SearchLimits& limits,
+                                                    SearchCallback onDone) {
+    stop();
+
+    // The last result's first move must be on the board, our stone, with
+    // the opponent to move; its reply is the prediction.
+    const std::vector<Move>& pv = lastResult_.principalVariation;
+    if (pv.size() < 2) return std::future<SearchResult>();
+    const int ourCell = (rootSide_ == Player::Black) ? 1 : 2;
+    if (board_.getCellState(pv[0].x, pv[0].y) != ourCell ||
+        board_.sideToMove() == rootSide_ ||
+        board_.isOccupied(pv[1].x, pv[1].y)) {
+        return std::future<SearchResult>();
+    }
+    const Move predicted = pv[1];
+
+    SearchLimits timed = limits;
+    if (!timed.stopToken) timed.stopToken = &asyncStop_;
+    asyncStopFlag_ = timed.stopToken;
+    asyncStopFlag_->store(false, std::memory_order_relaxed);
+
+    SearchLimits ponder = timed;
+    ponder.maxNodes        = 0;
+    ponder.timeLimitMs     = 0;
+    ponder.remainingTimeMs = 0;
+    {
+        std::lock_guard<std::mutex> lock(ponderMutex_);
+        stopRequested_ = false;
+        ponderState_   = PonderState::Pondering;
+        ponderMove_    = predicted;
+    }
+
+    // A ponder search and the search after its hit count as one move.
+    if (history_) history_->decay();
+
+    std::promise<SearchResult> promise;
+    std::future<SearchResult> future = promise.get_future();
+    asyncRunning_.store(true, std::memory_order_release);
+    asyncThread_ = std::thread([this, timed, ponder, predicted, onDone,
+                                p = std::move(promise)]() mutable {
+        board_.makeMove(predicted.x, predicted.y);
+        if (threatSolver_) threatSolver_->notifyMove(predicted);
+        runSearch(ponder);
+
+        // The ponder search may end on its own (depth limit, mate); wait
+        // for the verdict on the prediction either way.
+        PonderState verdict;
+        {
+            std::unique_lock<std::mutex> lock(ponderMutex_);
+            ponderCv_.wait(lock, [this] { return ponderState_ != PonderState::Pondering; });
+            verdict = ponderState_;
+            ponderState_ = PonderState::None;
+            if (verdict == PonderState::Hit && !stopRequested_) {
+                timed.stopToken->store(false, std::memory_order_relaxed);
+            }
+        }
+
+        if (verdict == PonderState::Hit) {
+            SearchResult r = runSearch(timed);
+            if (onDone) onDone(r);
+            asyncRunning_.store(false, std::memory_order_release);
+            p.set_value(r);
+            return;
+        }
+        board_.unmakeMove(predicted.x, predicted.y);
+        if (threatSolver_) threatSolver_->notifyUndo(predicted);
+        asyncRunning_.store(false, std::memory_order_release);
+        p.set_value(SearchResult{});
+    });
+    return future;
+}
+
+bool SearchEngine::ponderhit(const Move& move) {
+    bool hit;
+    {
+        std::lock_guard<std::mutex> lock(ponderMutex_);
+        if (ponderState_ != PonderState::Pondering) return false;
+        hit = (move == ponderMove_);
+        ponderState_ = hit ? PonderState::Hit : PonderState::Miss;
+        // Under the lock, so the search thread re-arms the flag after this.
+        asyncStopFlag_->store(true, std::memory_order_relaxed);
+    }
+    ponderCv_.notify_all();
+    if (!hit && asyncThread_.joinable()) asyncThread_.join();
+    return hit;
+}
+
+void SearchEngine::stop() {
+    {
+        std::lock_guard<std::mutex> lock(ponderMutex_);
+        stopRequested_ = true;
+        if (ponderState_ == PonderState::Pondering) ponderState_ = PonderState::Miss;
+        asyncStopFlag_->store(true, std::memory_order_relaxed);
+    }
+    ponderCv_.notify_all();
+    if (asyncThread_.joinable()) asyncThread_.join();
+    asyncStopFlag_ = &asyncStop_;
+}
+
+bool SearchEngine::isPondering() const {
+    std::lock_guard<std::mutex> lock(ponderMutex_);
+    return ponderState_ == PonderState::Pondering;
+}
+
+void SearchEngine::prepareSearch(const SearchLimits& limits) {
+    limits_     = limits;
+    rootSide_   = board_.sideToMove();
+    nodes_.reset();
+    qnodes_.reset();
+    hashHits_   = 0;
+    lastResult_ = SearchResult{};
+    rootExcluded_[0] = rootExcluded_[1] = rootExcluded_[2] = 0ULL;
+    startDepth_ = 1;
+    evaluator_.syncFromBoard(board_);
+    stats_.reset();
+    statsStartTicks_ = statsTicks();
+    statsStartTime_  = std::chrono::steady_clock::now();
+    timeManager_.start(limits_);
+}
+
+bool SearchEngine::confirmWithDfpn(Player attacker) {
+    if (limits_.dfpnMaxNodes == 0) return false;
+    if (!dfpn_) dfpn_.reset(new DfpnSolver());
+    // Full width: the default df-pn mode misses quiet defences, so only a
+    // full-width proof holds against every reply.  A confirmed win ends the
+    // search, so it may take the whole soft limit; a loss leaves half of it
+    // to the root search.
+    DfpnLimits dl;
+    dl.maxNodes         = limits_.dfpnMaxNodes;
+    dl.timeLimitMs      = attacker == rootSide_ ? timeManager_.softLimitMs()
+                                                : timeManager_.softLimitMs() / 2;
+    dl.abortFlag        = timeManager_.stopFlag();
+    dl.fullWidthDefence = true;
+    return dfpn_->solve(board_, attacker, dl).status == DfpnStatus::Proven;
+}
+
+int SearchEngine::seedFromPreviousSearch() {
+    const int stones = board_.countStones(Player::Black) + board_.countStones(Player::White);
+    const int played = stones - prevRootStones_;
+    if (prevRootStones_ < 0 || prevDepth_ <= 0 || played < 0 || played > 2 ||
+        static_cast<int>(prevPV_.size()) <= played) {
+        return 1;
+    }
+
+    // The moves since the previous root must be the PV's first moves.  Take
+    // them back to compare the hash, then replay them.
+    bool matches = true;
+    int undone = 0;
+    for (int i = played - 1; i >= 0; --i) {
+        const Move& m = prevPV_[static_cast<std::size_t>(i)];
+        // unmakeMove() needs a stone of the side that just moved.
+        const int lastMover = (board_.sideToMove() == Player::Black) ? 2 : 1;
+        if (board_.getCellState(m.x, m.y) != lastMover) {
+            matches = false;
+            break;
+        }
+        board_.unmakeMove(m.x, m.y);
+        ++undone;
+    }
+    matches = matches && board_.getHashKey() == prevRootKey_;
+    for (int i = played - undone; i < played; ++i) {
+        const Move& m = prevPV_[static_cast<std::size_t>(i)];
+        board_.makeMove(m.x, m.y);
+    }
+    if (!matches) return 1;
+
+    // Re-seed the TT with the rest of the PV (move hints only: depth 0
+    // entries never cause a cutoff) where it lost them.
+    Move line[kMaxPly];
+    int  made = 0;
+    for (std::size_t i = static_cast<std::size_t>(played); i < prevPV_.size() && made < kMaxPly; ++i) {
+        const Move& m = prevPV_[i];
+        if (board_.isOccupied(m.x, m.y)) break;
+        TTEntry e;
+        int symmetry = 0;
+        const std::uint64_t key = board_.getCanonicalKey(&symmetry);
+        if (!tt_.probe(key, e) || e.bestMove == kNoMove) {
+            tt_.store(key, 0, 0, 0, TTNodeType::UpperBound, toTTMove(m, symmetry));
+        }
+        board_.makeMove(m.x, m.y);
+        line[made++] = m;
+        if (board_.checkWinAt(m.x, m.y)) break;
+    }
+    while (made > 0) {
+        const Move& m = line[--made];
+        board_.unmakeMove(m.x, m.y);
+    }
+
+    const Move& next = prevPV_[static_cast<std::size_t>(played)];
+    if (!board_.isOccupied(next.x, next.y)) lastResult_.bestMove = next;
+    return std::max(1, prevDepth_ - kSeedDepthMargin);
+}
+
+void SearchEngine::rememberSearch() {
+    prevRootKey_    = board_.getHashKey();
+    prevRootStones_ = board_.countStones(Player::Black) + board_.countStones(Player::White);
+    prevDepth_      = lastResult_.depthReached;
+    prevPV_         = lastResult_.principalVariation;
+}
+
+void SearchEngine::startHelpers() {
+    const int count = std::max(1, limits_.threads) - 1;
+    if (count == 0) return;
+
+    // Helpers run until the main thread's stop flag is set.  They get no
+    // clock of their own: the main thread's TimeManager (with its panic
+    // extensions) is the only one that stops the search.
+    SearchLimits helperLimits = limits_;
+    helperLimits.maxNodes        = 0;
+    helperLimits.timeLimitMs     = 0;
+    helperLimits.remainingTimeMs = 0;
+    helperLimits.incrementMs     = 0;
+    helperLimits.movesToGo       = 0;
+    helperLimits.threads         = 1;
+    helperLimits.ttSizeMB        = 0;
+    helperLimits.stopToken       = timeManager_.stopFlag();
+
+    for (int i = 0; i < count; ++i) {
+        std::unique_ptr<HelperThread> h(new HelperThread(board_));
+        h->evaluator = evaluator_.clone();
+        if (!h->evaluator) {
+            helpers_.clear(); // not cloneable: stay single-threaded
+            return;
+        }
+        if (threatSolver_) h->threatSolver = threatSolver_->clone(h->board);
+        if (history_) h->history = history_->clone();
+        h->engine.reset(new SearchEngine(h->board, *h->evaluator, h->threatSolver.get(),
+                                         h->history.get(), tt_));
+        h->engine->prepareSearch(helperLimits);
+        std::copy(rootExcluded_, rootExcluded_ + 3, h->engine->rootExcluded_);
+        h->engine->startDepth_ = startDepth_;
+        helpers_.push_back(std::move(h));
+    }
+    for (std::size_t i = 0; i < helpers_.size(); ++i) {
+        SearchEngine* engine = helpers_[i]->engine.get();
+        const int threadIndex = static_cast<int>(i) + 1;
+        helpers_[i]->thread = std::thread([engine, threadIndex] {
+            engine->iterativeDeepening(threadIndex);
+        });
+    }
+}
+
+void SearchEngine::joinHelpers() {
+    if (helpers_.empty()) return;
+    timeManager_.requestStop();
+    for (auto& h : helpers_) {
+        if (h->thread.joinable()) h->thread.join();
+    }
+    for (auto& h : helpers_) {
+        const SearchEngine& e = *h->engine;
+        nodes_.add(e.nodes_.get());
+        qnodes_.add(e.qnodes_.get());
+        hashHits_ += e.hashHits_;
+        const SearchResult& r = e.lastResult_;
+        if (r.depthReached > lastResult_.depthReached && !(r.bestMove == kNoMove)) {
+            lastResult_.bestMove           = r.bestMove;
+            lastResult_.bestScore          = r.bestScore;
+            lastResult_.depthReached       = r.depthReached;
+            lastResult_.isMate             = r.isMate;
+            lastResult_.principalVariation = r.principalVariation;
+        }
+    }
+    helpers_.clear();
+}
+
+bool SearchEngine::proveRootMoves(const MoveList& candidates, const ThreatAnalysis& opp) {
+    // Candidates plus any defense outside them.
+    MoveList moves = candidates;
+    for (const Move& d : opp.defensiveMoves) {
+        if (std::find(moves.begin(), moves.end(), d) == moves.end()) moves.push_back(d);
+    }
+
+    ThreatSearchLimits tl;
+    tl.abortFlag = timeManager_.stopFlag();
+    const RootProofResult proofs =
+        threatSolver_->proveRootMoves(board_, moves, std::max(1, limits_.threads), tl);
+    if (proofs.foundWin) {
+        // The proof gives no line, so the distance to mate is unknown.
+        lastResult_.bestMove    = proofs.winningMove;
+        lastResult_.bestScore   = mateScoreFor(rootSide_, rootSide_, kMaxPly);
+        lastResult_.isMate      = true;
+        lastResult_.isForcedWin = true;
+        lastResult_.principalVariation.assign(1, proofs.winningMove);
+        return true;
+    }
+    // Lost anyway: let the search pick the longest resistance.
+    if (proofs.allLost) return false;
+
+    bool fallbackSet = false;
+    for (std::size_t i = 0; i < moves.size(); ++i) {
+        const Move& m = moves[i];
+        if (proofs.proofs[i] == RootMoveProof::Loss) {
+            const int idx = m.y * 12 + m.x;
+            rootExcluded_[idx >> 6] |= 1ULL << (idx & 63);
+        } else if (!fallbackSet) {
+            lastResult_.bestMove = m;
+            fallbackSet = true;
+        }
+    }
+    return false;
+}
+
+void SearchEngine::reportIteration(int depth, EvalScore score) {
+    SearchInfo info;
+    info.depth              = depth;
+    info.selDepth           = stats_.selDepth;
+    info.score              = score;
+    info.isMate             = isMateScore(score);
+    info.principalVariation = lastResult_.principalVariation;
+
+    const double elapsedMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - statsStartTime_).count();
+    info.nodes    = totalNodes();
+    info.timeMs   = static_cast<std::uint64_t>(elapsedMs);
+    info.nps      = elapsedMs > 0.0 ? static_cast<std::uint64_t>(info.nodes * 1000.0 / elapsedMs) : 0;
+    info.hashfull = tt_.hashfull();
+
+    if (stats_.ttProbes) info.ttHitRate = static_cast<double>(hashHits_) / stats_.ttProbes;
+    if (threatSolver_) {
+        const ThreatCacheStats now = threatSolver_->cacheStats();
+        const std::uint64_t hits   = now.hits - threatCacheAtStart_.hits;
+        const std::uint64_t misses = now.misses - threatCacheAtStart_.misses;
+        if (hits + misses) info.threatCacheHitRate = static_cast<double>(hits) / (hits + misses);
+    }
+    if (stats_.cutoffs) {
+        info.firstMoveCutoffRate = static_cast<double>(stats_.firstMoveCutoffs) / stats_.cutoffs;
+    }
+
+    const std::uint64_t ticks = statsTicks() - statsStartTicks_;
+    if (ticks) {
+        const double msPerTick = elapsedMs / static_cast<double>(ticks);
+        info.threatMs  = stats_.phaseTicks[static_cast<int>(SearchPhase::Threats)] * msPerTick;
+        info.evalMs    = stats_.phaseTicks[static_cast<int>(SearchPhase::Eval)] * msPerTick;
+        info.moveGenMs = stats_.phaseTicks[static_cast<int>(SearchPhase::MoveGen)] * msPerTick;
+    }
+    onInfo_(info);
+}
+
+std::uint64_t SearchEngine::totalNodes() const {
+    std::uint64_t total = nodes_.get() + qnodes_.get();
+    for (const auto& h : helpers_) {
+        total += h->engine->nodes_.get() + h->engine->qnodes_.get();
+    }
+    return total;
+}
+
+void SearchEngine::iterativeDeepening(int threadIndex) {
+    const int maxDepth = std::min(limits_.maxDepth, kMaxPly - 1);
+    for (int depth = std::min(startDepth_, maxDepth); depth <= maxDepth; ++depth) {
+        if (threadIndex > 0) {
+            const int i = (threadIndex - 1) % kSkipTableSize;
+            if (((depth + kSkipPhase[i]) / kSkipSize[i]) % 2) continue;
+        }
+        rootBestMove_ = kNoMove;
+        EvalScore score = search(depth, -kInfinity, kInfinity, 0, false, true);
+
+        // A partial iteration is discarded.
+        if (timeManager_.isStopped()) break;
+        if (rootBestMove_ == kNoMove) break;
+
+        lastResult_.bestMove     = rootBestMove_;
+        lastResult_.bestScore    = score;
+        lastResult_.depthReached = depth;
+        lastResult_.isMate       = isMateScore(score);
+        extractPrincipalVariation(lastResult_.principalVariation, depth);
+        if (threadIndex == 0 && onInfo_) reportIteration(depth, score);
+
+        if (lastResult_.isMate) break;
+
+        // Soft time limit: stable best move, score drops, root danger.
+        if (threadIndex == 0) {
+            timeManager_.onIterationComplete(rootBestMove_, score);
+            if (!timeManager_.canStartIteration()) break;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+// Principal variation search
+//------------------------------------------------------------------------------
+
+EvalScore SearchEngine::search(int depth, EvalScore alpha, EvalScore beta,
+                               int ply, bool allowNull, bool inPV) {
+    nodes_.increment();
+    GOMOKU_STATS(stats_.selDepth = std::max(stats_.selDepth, ply));
+    if (shouldStop()) return 0;
+
+    if (depth <= 0 || ply >= kMaxPly - 1) {
+        return quiescence(alpha, beta, ply, 0);
+    }
+
+    const Player side       = board_.sideToMove();
+    const bool   maximizing = (side == rootSide_);
+    int symmetry = 0;
+    const std::uint64_t key = board_.getCanonicalKey(&symmetry);
+
+    // --- Transposition table ---
+    Move ttMove = kNoMove;
+    TTEntry entry;
+    GOMOKU_STATS(++stats_.ttProbes);
+    if (tt_.probe(key, entry)) {
+        ++hashHits_;
+        ttMove = fromTTMove(entry.bestMove, symmetry);
+        if (!inPV && ply > 0 && entry.depth >= depth) {
+            EvalScore v = toSideToMove(TranspositionTable::fromTTScore(entry.value, ply), maximizing);
+            TTNodeType t = flipBound(entry.type, maximizing);
+            if (t == TTNodeType::Exact) return v;
+            if (t == TTNodeType::LowerBound && v >= beta) return v;
+            if (t == TTNodeType::UpperBound && v <= alpha) return v;
+        }
+    }
+
+    // --- Threats ---
+    ThreatAnalysis own;
+    ThreatAnalysis opp;
+    bool restrictToDefenses = false;
+    if (threatSolver_) {
+        ThreatSearchLimits tl;
+        tl.abortFlag = timeManager_.stopFlag();
+        if (ply > 0) tl.maxNodes = kNodeThreatBudget;
+        {
+            PhaseTimer timer(stats_, SearchPhase::Threats);
+            own = threatSolver_->analyzeThreats(board_, side, tl);
+        }
+        if (own.attackerHasForcedWin && !own.winningLine.empty()) {
+            int plies = ply + 2 * static_cast<int>(own.winningLine.size()) - 1;
+            EvalScore score = mateScoreFor(side, rootSide_, plies);
+            if (ply == 0) rootBestMove_ = own.firstWinningMove;
+            tt_.store(key,
+                      TranspositionTable::toTTScore(toSideToMove(score, maximizing), ply),
+                      0, depth, TTNodeType::Exact, toTTMove(own.firstWinningMove, symmetry));
+            return score;
+        }
+        {
+            PhaseTimer timer(stats_, SearchPhase::Threats);
+            opp = threatSolver_->analyzeThreats(board_, opponentOf(side), tl);
+        }
+        restrictToDefenses = opp.attackerHasForcedWin && !opp.defensiveMoves.empty();
+    }
+
+    // --- Null move ---
+    if (allowNull && !inPV && canDoNullMove(opp, depth, ply)) {
+        EvalScore s = nullMoveSearch(alpha, beta, depth, ply);
+        if (timeManager_.isStopped()) return 0;
+        if (maximizing ? s >= beta : s <= alpha) return s;
+    }
+
+    // --- Moves ---
+    const Move previous = (ply > 0) ? playedAt_[ply - 1] : kNoMove;
+    OrderingHints hints;
+    if (history_) history_->getOrderingHints(side, ply, previous, hints);
+    MovePicker picker(board_, side, ttMove == kNoMove ? nullptr : &ttMove,
+                      threatSolver_ ? &own : nullptr, threatSolver_ ? &opp : nullptr,
+                      restrictToDefenses, history_, history_ ? &hints : nullptr,
+                      plyBuffers_[ply]);
+    Move quietsTried[kMaxQuietsTracked];
+    int  quietCount = 0;
+
+    const EvalScore alphaOrig = alpha;
+    const EvalScore betaOrig  = beta;
+    EvalScore best     = maximizing ? -kInfinity : kInfinity;
+    Move      bestMove = kNoMove;
+    int       moveCount = 0;
+
+    auto nextMove = [&](Move& out) {
+        PhaseTimer timer(stats_, SearchPhase::MoveGen);
+        return picker.next(out);
+    };
+    Move m;
+    while (nextMove(m)) {
+        if (ply == 0 && isRootExcluded(m)) continue;
+        playedAt_[ply] = m;
+        EvalScore score;
+        {
+            MoveGuard guard(board_, m, threatSolver_, &tt_, &evaluator_);
+            if (!guard.isValid()) continue;
+            ++moveCount;
+            if (board_.checkWinAt(m.x, m.y)) {
+                score = mateScoreFor(side, rootSide_, ply + 1);
+            } else if (moveCount == 1) {
+                score = search(depth - 1, alpha, beta, ply + 1, true, inPV);
+            } else if (maximizing) {
+                // Zero window: prove the move is no better than alpha.
+                score = search(depth - 1, alpha, alpha + 1, ply + 1, true, false);
+                if (score > alpha && score < beta) {
+                    score = search(depth - 1, alpha, beta, ply + 1, true, inPV);
+                }
+            } else {
+                score = search(depth - 1, beta - 1, beta, ply + 1, true, false);
+                if (score < beta && score > alpha) {
+                    score = search(depth - 1, alpha, beta, ply + 1, true, inPV);
+                }
+            }
+        }
+        if (timeManager_.isStopped()) return 0;
+
+        if (maximizing ? score > best : score < best) {
+            best     = score;
+            bestMove = m;
+            if (ply == 0) rootBestMove_ = m;
+        }
+        if (maximizing) {
+            if (best > alpha) alpha = best;
+        } else {
+            if (best < beta) beta = best;
+        }
+        if (alpha >= beta) {
+            GOMOKU_STATS(++stats_.cutoffs);
+            GOMOKU_STATS(stats_.firstMoveCutoffs += (moveCount == 1));
+            if (history_) {
+                history_->recordBetaCutoff(side, m, depth, ply, previous);
+                if (picker.lastWasQuiet()) {
+                    for (int i = 0; i < quietCount; ++i) {
+                        history_->recordFailedMove(side, quietsTried[i], depth);
+                    }
+                }
+            }
+            break;
+        }
+        if (picker.lastWasQuiet() && quietCount < kMaxQuietsTracked) {
+            quietsTried[quietCount++] = m;
+        }
+    }
+
+    if (moveCount == 0) {
+        // Board full: draw.
+        return kDrawScore;
+    }
+
+    TTNodeType type = TTNodeType::Exact;
+    if (best <= alphaOrig)      type = TTNodeType::UpperBound;
+    else if (best >= betaOrig)  type = TTNodeType::LowerBound;
+    tt_.store(key,
+              TranspositionTable::toTTScore(toSideToMove(best, maximizing), ply),
+              0, depth, flipBound(type, maximizing), toTTMove(bestMove, symmetry));
+    if (inPV && type == TTNodeType::Exact && history_) {
+        history_->recordPVMove(side, bestMove, depth);
+    }
+    return best;
+}
+
+EvalScore SearchEngine::quiescence(EvalScore alpha, EvalScore beta, int ply, int qply) {
+    qnodes_.increment();
+    GOMOKU_STATS(stats_.selDepth = std::max(stats_.selDepth, ply));
+    if (shouldStop()) return 0;
+
+    // Stand pat: static evaluation from the root side's perspective.
+    EvalScore standPat;
+    {
+        PhaseTimer timer(stats_, SearchPhase::Eval);
+        standPat = evaluator_.evaluate(board_, rootSide_);
+    }
+    if (!threatSolver_ || ply >= kMaxPly - 1 || qply >= kMaxQuiescencePly) return standPat;
+
+    const Player side       = board_.sideToMove();
+    const bool   maximizing = (side == rootSide_);
+    ForcingMoves own;
+    ForcingMoves opp;
+    {
+        PhaseTimer timer(stats_, SearchPhase::Threats);
+        if (!threatSolver_->collectForcingMoves(board_, side, own)) return standPat;
+        if (own.fives.empty()) threatSolver_->collectForcingMoves(board_, opponentOf(side), opp);
+    }
+    if (!own.fives.empty()) return mateScoreFor(side, rootSide_, ply + 1);
+
+    // The opponent's four must be blocked; two five squares cannot be.
+    if (opp.fives.size() >= 2) return mateScoreFor(opponentOf(side), rootSide_, ply + 2);
+    if (opp.fives.size() == 1) {
+        MoveGuard guard(board_, opp.fives[0], threatSolver_, nullptr, &evaluator_);
+        if (!guard.isValid()) return standPat;
+        return quiescence(alpha, beta, ply + 1, qply + 1);
+    }
+
+    EvalScore best = standPat;
+    if (maximizing) {
+        if (best >= beta) return best;
+        if (best > alpha) alpha = best;
+    } else {
+        if (best <= alpha) return best;
+        if (best < beta) beta = best;
+    }
+
+    const MoveList* stages[2] = { &own.fours,
+                                  qply < kQuiescenceThreePly ? &own.threes : nullptr };
+    for (const MoveList* moves : stages) {
+        if (!moves) continue;
+        for (const Move& m : *moves) {
+            EvalScore score;
+            {
+                MoveGuard guard(board_, m, threatSolver_, nullptr, &evaluator_);
+                if (!guard.isValid()) continue;
+                score = quiescence(alpha, beta, ply + 1, qply + 1);
+            }
+            if (timeManager_.isStopped()) return 0;
+
+            if (maximizing ? score > best : score < best) best = score;
+            if (maximizing) {
+                if (best > alpha) alpha = best;
+            } else {
+                if (best < beta) beta = best;
+            }
+            if (alpha >= beta) return best;
+        }
+    }
+    return best;
+}
+
+//------------------------------------------------------------------------------
+// Helpers
+//------------------------------------------------------------------------------
+
+bool SearchEngine::canDoNullMove(const ThreatAnalysis& threatInfo, int depth, int ply) const {
+    // Passing while the opponent has a winning threat is never safe.
+    return limits_.enableNullMove && ply > 0 && depth > kNullMoveReduction &&
+           !threatInfo.attackerHasForcedWin;
+}
+
+EvalScore SearchEngine::nullMoveSearch(EvalScore alpha, EvalScore beta, int depth, int ply) {
+    const bool maximizing = (board_.sideToMove() == rootSide_);
+    board_.makeNullMove();
+    playedAt_[ply] = kNoMove;
+    tt_.prefetch(board_.getCanonicalKey());
+    EvalScore s = maximizing
+        ? search(depth - 1 - kNullMoveReduction, beta - 1, beta, ply + 1, false, false)
+        : search(depth - 1 - kNullMoveReduction, alpha, alpha + 1, ply + 1, false, false);
+    board_.unmakeNullMove();
+    // A pass never proves a mate.
+    if (isMateScore(s)) return maximizing ? beta - 1 : alpha + 1;
+    return s;
+}
+
+void SearchEngine::extractPrincipalVariation(std::vector<Move>& outPV, int maxDepth) {
+    outPV.clear();
+    Move line[kMaxPly];
+    int  made = 0;
+    while (made < maxDepth && made < kMaxPly) {
+        TTEntry e;
+        int symmetry = 0;
+        if (!tt_.probe(board_.getCanonicalKey(&symmetry), e)) break;
+        const Move m = fromTTMove(e.bestMove, symmetry);
+        if (board_.isOccupied(m.x, m.y)) break; // kNoMove or stale entry
+        board_.makeMove(m.x, m.y);
+        if (threatSolver_) threatSolver_->notifyMove(m);
+        line[made++] = m;
+        outPV.push_back(m);
+        if (board_.checkWinAt(m.x, m.y)) break;
+    }
+    while (made > 0) {
+        const Move m = line[--made];
+        board_.unmakeMove(m.x, m.y);
+        if (threatSolver_) threatSolver_->notifyUndo(m);
+    }
+}
+
+} // namespace gomoku
@@ -0,0 +1,195 @@
+// evaluator.cpp
+// Implementation of the incremental PatternEvaluator.
+
+#include "search/evaluator.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "core/bit_utils.h"
+#include "tactics/pattern_table.h"
+
+namespace gomoku {
+
+namespace {
+
+inline int sideIndex(Player p) { return p == Player::Black ? 0 : 1; }
+
+// Value of one threat for its owner, strongest first as in ThreatType.
+EvalScore threatWeight(ThreatType t) {
+    switch (t) {
+        case ThreatType::Five:         return 10000;
+        case ThreatType::OpenFour:     return 4000;
+        case ThreatType::SimpleFour:   return 600;
+        case ThreatType::OpenThree:    return 500;
+        case ThreatType::BrokenThree:  return 400;
+        case ThreatType::SimpleThree:  return 80;
+        case ThreatType::TwoFourWays:  return 60;
+        case ThreatType::TwoThreeWays: return 40;
+        case ThreatType::TwoTwoWays:   return 25;
+        case ThreatType::TwoOneWay:    return 10;
+        case ThreatType::OneFiveWays:  return 8;
+        case ThreatType::OneFourWays:  return 6;
+        case ThreatType::OneThreeWays: return 4;
+        case ThreatType::OneTwoWays:   return 2;
+        case ThreatType::OneOneWay:    return 1;
+        default:                       return 0;
+    }
+}
+
+// Score and forcing-threat count of every sub-line (length, stone mask),
+// folded from PatternTable::candidatePatterns once on first use.
+class SubLineTable {
+public:
+    static const SubLineTable& instance() {
+        static const SubLineTable table;
+        return table;
+    }
+
+    EvalScore score(int len, std::uint32_t mask) const { return score_[base_[len] + mask]; }
+    int forcing(int len, std::uint32_t mask) const { return forcing_[base_[len] + mask]; }
+
+private:
+    SubLineTable() {
+        const PatternTable& pt = PatternTable::instance();
+        std::size_t size = 0;
+        for (int len = PatternTable::kMinSubLine; len <= PatternTable::kMaxSubLine; ++len) {
+            base_[len] = static_cast<std::uint32_t>(size);
+            size += std::size_t(1) << len;
+        }
+        score_.assign(size, 0);
+        forcing_.assign(size, 0);
+        for (int len = PatternTable::kMinSubLine; len <= PatternTable::kMaxSubLine; ++len) {
+            for (std::uint32_t mask = 0; mask < (1u << len); ++mask) {
+                int count = 0;
+                const PatternRef* refs = pt.candidatePatterns(len, mask, count);
+                EvalScore s = 0;
+                int f = 0;
+                for (int i = 0; i < count; ++i) {
+                    const ThreatType t = pt.pattern(refs[i].patternId).type;
+                    s += threatWeight(t);
+                    if (isForcingOrWinning(t)) ++f;
+                }
+                score_[base_[len] + mask]   = s;
+                forcing_[base_[len] + mask] = static_cast<std::uint8_t>(std::min(f, 255));
+            }
+        }
+    }
+
+    std::vector<EvalScore>    score_;
+    std::vector<std::uint8_t> forcing_;
+    std::uint32_t             base_[PatternTable::kMaxSubLine + 1] = {};
+};
+
+} // namespace
+
+EvalScore PatternEvaluator::evaluate(const Board& board, Player maxPlayer) {
+    if (&board != board_ ||
+        board.countStones(Player::Black) + board.countStones(Player::White) != stones_) {
+        syncFromBoard(board);
+    }
+
+    const int me  = sideIndex(maxPlayer);
+    const int opp = 1 - me;
+    EvalScore s = total_[me] - total_[opp];
+    if (forcing_[me] >= 2)  s += kDoubleThreatBonus;
+    if (forcing_[opp] >= 2) s -= kDoubleThreatBonus;
+    s += (board.sideToMove() == maxPlayer) ? kTempoBonus : -kTempoBonus;
+    return std::max(-kMaxEval, std::min(kMaxEval, s));
+}
+
+void PatternEvaluator::syncFromBoard(const Board& board) {
+    board_  = &board;
+    stones_ = board.countStones(Player::Black) + board.countStones(Player::White);
+    total_[0] = total_[1] = 0;
+    forcing_[0] = forcing_[1] = 0;
+    undo_.clear();
+    for (int dir = 0; dir < Board::kNumDirections; ++dir) {
+        for (int id = 0; id < kLines; ++id) lines_[dir][id] = LineScore{};
+        for (int id = 0; id < Board::lineCount(dir); ++id) {
+            setLine(dir, id, scoreLine(board, dir, id));
+        }
+    }
+}
+
+void PatternEvaluator::notifyMove(const Move& m) {
+    if (!board_ || m.x < 0 || m.x >= 12 || m.y < 0 || m.y >= 12) return;
+    // Board has already updated its line bitboards in makeMove().
+    if (!undo_.full()) {
+        UndoRecord rec;
+        rec.cell = static_cast<std::uint8_t>(m.y * 12 + m.x);
+        for (int dir = 0; dir < Board::kNumDirections; ++dir) {
+            rec.lines[dir] = lines_[dir][Board::lineIdOf(dir, m.x, m.y)];
+        }
+        undo_.push_back(rec);
+    }
+    rescoreLinesThrough(m);
+    ++stones_;
+}
+
+void PatternEvaluator::notifyUndo(const Move& m) {
+    if (!board_ || m.x < 0 || m.x >= 12 || m.y < 0 || m.y >= 12) return;
+    --stones_;
+    // The normal case restores the lines saved by the matching notifyMove();
+    // anything else re-scores them from the (already unmade) board.
+    if (!undo_.empty() && undo_.back().cell == m.y * 12 + m.x) {
+        const UndoRecord& rec = undo_.back();
+        for (int dir = 0; dir < Board::kNumDirections; ++dir) {
+            setLine(dir, Board::lineIdOf(dir, m.x, m.y), rec.lines[dir]);
+        }
+        undo_.pop_back();
+        return;
+    }
+    rescoreLinesThrough(m);
+}
+
+std::unique_ptr<IEvaluator> PatternEvaluator::clone() const {
+    return std::make_unique<PatternEvaluator>(*this);
+}
+
+PatternEvaluator::LineScore PatternEvaluator::scoreLine(const Board& board,
+                                                        int dir, int lineId) const {
+    const SubLineTable& table = SubLineTable::instance();
+    const int len = Board::lineLength(dir, lineId);
+    const std::uint32_t full = (1u << len) - 1;
+
+    LineScore out;
+    for (int p = 0; p < 2; ++p) {
+        const Player me = p == 0 ? Player::Black : Player::White;
+        const Player other = p == 0 ? Player::White : Player::Black;
+        const std::uint32_t own = board.getLine(me, dir, lineId);
+        std::uint32_t free = ~static_cast<std::uint32_t>(board.getLine(other, dir, lineId)) & full;
+        // Walk the runs of cells not held by the opponent.
+        while (free) {
+            const int start = countTrailingZeros64(free);
+            const std::uint32_t rest = free >> start;
+            const int run = countTrailingZeros64(~static_cast<std::uint64_t>(rest));
+            const std::uint32_t runBits = (1u << run) - 1;
+            free &= ~(runBits << start);
+            if (run < PatternTable::kMinSubLine) continue;
+            const std::uint32_t mask = (own >> start) & runBits;
+            out.score[p]  += table.score(run, mask);
+            out.forcing[p] = static_cast<std::uint8_t>(
+                std::min(255, out.forcing[p] + table.forcing(run, mask)));
+        }
+    }
+    return out;
+}
+
+void PatternEvaluator::setLine(int dir, int lineId, const LineScore& s) {
+    LineScore& cur = lines_[dir][lineId];
+    for (int p = 0; p < 2; ++p) {
+        total_[p]   += s.score[p] - cur.score[p];
+        forcing_[p] += s.forcing[p] - cur.forcing[p];
+    }
+    cur = s;
+}
+
+void PatternEvaluator::rescoreLinesThrough(const Move& m) {
+    for (int dir = 0; dir < Board::kNumDirections; ++dir) {
+        const int id = Board::lineIdOf(dir, m.x, m.y);
+        setLine(dir, id, scoreLine(*board_, dir, id));
+    }
+}
+
+} // namespace gomoku
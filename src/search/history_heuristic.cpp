@@ -1,35 +1,105 @@
 // history_heuristic.cpp
 // Implementation of HistoryHeuristic for Gomoku search engine.
 
-#include "history_heuristic.h"
+#include "search/history_heuristic.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 
 namespace gomoku {
 
+namespace {
+
+inline bool onBoardMove(const Move& m) {
+    return m.x >= 0 && m.x < 12 && m.y >= 0 && m.y < 12;
+}
+
+// Row-major cell index, as everywhere else.
+inline int cellOf(const Move& m) { return m.y * 12 + m.x; }
+
+inline int sideIndex(Player p) { return p == Player::Black ? 0 : 1; }
+
+} // namespace
+
 HistoryHeuristic::HistoryHeuristic() {
-    reset();
+    clear();
 }
 
-void HistoryHeuristic::reset() {
-    // Zero out the history table.
-    std::memset(table, 0, sizeof(table));
+void HistoryHeuristic::clear() {
+    std::memset(butterfly_, 0, sizeof(butterfly_));
+    std::memset(counterMove_, kNoCell, sizeof(counterMove_));
+    for (auto& ply : killers_) {
+        for (Move& k : ply) k = Move(-1, -1);
+    }
 }
 
-void HistoryHeuristic::increment(const Move &m, int depth) {
-    // Only update the table for moves that fall on the board.
-    if (m.x >= 0 && m.x < 12 && m.y >= 0 && m.y < 12) {
-        // Increment by depth squared so deeper cutoffs contribute more.
-        int bonus = depth * depth;
-        // Use row-major indexing: first index is y (row), second is x (column).
-        table[m.y][m.x] += bonus;
+void HistoryHeuristic::decay() {
+    for (auto& side : butterfly_) {
+        for (int& s : side) s /= 2;
+    }
+    for (auto& ply : killers_) {
+        for (Move& k : ply) k = Move(-1, -1);
     }
 }
 
-int HistoryHeuristic::get(const Move &m) const {
-    if (m.x >= 0 && m.x < 12 && m.y >= 0 && m.y < 12) {
-        // Use the same row-major indexing as in increment().
-        return table[m.y][m.x];
+std::unique_ptr<IHistoryHeuristic> HistoryHeuristic::clone() const {
+    return std::unique_ptr<IHistoryHeuristic>(new HistoryHeuristic(*this));
+}
+
+void HistoryHeuristic::update(int& entry, int bonus) {
+    bonus = std::max(-kMaxScore, std::min(kMaxScore, bonus));
+    entry += bonus - entry * std::abs(bonus) / kMaxScore;
+}
+
+int HistoryHeuristic::getHistoryScore(Player sideToMove, const Move& move) const {
+    if (!onBoardMove(move)) return 0;
+    return butterfly_[sideIndex(sideToMove)][cellOf(move)];
+}
+
+void HistoryHeuristic::recordBetaCutoff(Player sideToMove, const Move& move, int depth) {
+    if (!onBoardMove(move)) return;
+    update(butterfly_[sideIndex(sideToMove)][cellOf(move)], depth * depth);
+}
+
+void HistoryHeuristic::recordBetaCutoff(Player sideToMove, const Move& move, int depth,
+                                        int ply, const Move& previousMove) {
+    if (!onBoardMove(move)) return;
+    recordBetaCutoff(sideToMove, move, depth);
+
+    if (ply >= 0 && ply < kMaxPly) {
+        Move* k = killers_[ply];
+        if (!(k[0] == move)) {
+            k[1] = k[0];
+            k[0] = move;
+        }
+    }
+    if (onBoardMove(previousMove)) {
+        counterMove_[sideIndex(sideToMove)][cellOf(previousMove)] =
+            static_cast<std::uint8_t>(cellOf(move));
+    }
+}
+
+void HistoryHeuristic::recordFailedMove(Player sideToMove, const Move& move, int depth) {
+    if (!onBoardMove(move)) return;
+    update(butterfly_[sideIndex(sideToMove)][cellOf(move)], -depth * depth);
+}
+
+void HistoryHeuristic::recordPVMove(Player sideToMove, const Move& move, int depth) {
+    if (!onBoardMove(move)) return;
+    update(butterfly_[sideIndex(sideToMove)][cellOf(move)], depth);
+}
+
+void HistoryHeuristic::getOrderingHints(Player sideToMove, int ply, const Move& previousMove,
+                                        OrderingHints& out) const {
+    out = OrderingHints{};
+    if (ply >= 0 && ply < kMaxPly) {
+        for (int i = 0; i < OrderingHints::kKillers; ++i) out.killers[i] = killers_[ply][i];
+    }
+    if (onBoardMove(previousMove)) {
+        const std::uint8_t c = counterMove_[sideIndex(sideToMove)][cellOf(previousMove)];
+        if (c != kNoCell) out.counterMove = Move(c % 12, c / 12);
     }
-    return 0;
 }
 
-} // namespace gomoku
\ No newline at end of file
+} // namespace gomoku
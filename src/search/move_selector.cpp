@@ -0,0 +1,118 @@
+// move_selector.cpp
+// Staged move picker (see move_selector.h).
+
+#include "search/move_selector.h"
+
+namespace gomoku {
+
+MovePicker::MovePicker(const Board&             board,
+                       Player                   sideToMove,
+                       const Move*              ttMove,
+                       const ThreatAnalysis*    ownThreats,
+                       const ThreatAnalysis*    oppThreats,
+                       bool                     restrictToDefenses,
+                       const IHistoryHeuristic* history,
+                       const OrderingHints*     hints,
+                       MoveBuffer&              buffer)
+    : board_(board), side_(sideToMove), ttMove_(ttMove), own_(ownThreats),
+      opp_(oppThreats), restrict_(restrictToDefenses && oppThreats != nullptr),
+      history_(history), hints_(hints), buffer_(buffer) {}
+
+bool MovePicker::isDefense(const Move& m) const {
+    for (const Move& d : opp_->defensiveMoves) {
+        if (d == m) return true;
+    }
+    return false;
+}
+
+bool MovePicker::tryYield(const Move& m, Move& out) {
+    if (board_.isOccupied(m.x, m.y)) return false; // also rejects off-board
+    const int idx = m.y * 12 + m.x;
+    const uint64_t bit = 1ULL << (idx & 63);
+    if (yielded_[idx >> 6] & bit) return false;
+    yielded_[idx >> 6] |= bit;
+    out = m;
+    return true;
+}
+
+bool MovePicker::next(Move& out) {
+    switch (stage_) {
+        case Stage::TTMove:
+            stage_ = Stage::Threats;
+            if (ttMove_ && (!restrict_ || isDefense(*ttMove_)) && tryYield(*ttMove_, out)) {
+                yieldedFrom_ = Stage::TTMove;
+                return true;
+            }
+            // fall through
+        case Stage::Threats:
+            if (threatIndex_ == 0) {
+                ++threatIndex_;
+                if (own_ && own_->attackerHasForcedWin && !restrict_ &&
+                    tryYield(own_->firstWinningMove, out)) {
+                    yieldedFrom_ = Stage::Threats;
+                    return true;
+                }
+            }
+            while (opp_ && threatIndex_ <= opp_->defensiveMoves.size()) {
+                const Move& m = opp_->defensiveMoves[threatIndex_ - 1];
+                ++threatIndex_;
+                if (tryYield(m, out)) {
+                    yieldedFrom_ = Stage::Threats;
+                    return true;
+                }
+            }
+            stage_ = restrict_ ? Stage::Done : Stage::Killers;
+            if (restrict_) return false;
+            // fall through
+        case Stage::Killers:
+            while (hints_ && hintIndex_ <= OrderingHints::kKillers) {
+                const Move m = (hintIndex_ < OrderingHints::kKillers)
+                             ? hints_->killers[hintIndex_] : hints_->counterMove;
+                ++hintIndex_;
+                if (m.x < 0 || m.x >= 12 || m.y < 0 || m.y >= 12) continue;
+                if (board_.neighbourStoneCount(m.x, m.y) == 0) continue;
+                if (tryYield(m, out)) {
+                    yieldedFrom_ = Stage::Killers;
+                    return true;
+                }
+            }
+            stage_ = Stage::GenerateQuiet;
+            // fall through
+        case Stage::GenerateQuiet:
+            board_.getCandidateMoves(buffer_.moves);
+            for (std::size_t i = 0; i < buffer_.moves.size(); ++i) {
+                buffer_.scores[i] = history_ ? history_->getHistoryScore(side_, buffer_.moves[i]) : 0;
+            }
+            quietIndex_ = 0;
+            stage_ = Stage::Quiet;
+            // fall through
+        case Stage::Quiet:
+            while (quietIndex_ < buffer_.moves.size()) {
+                // Selection step: swap the best remaining move into place.
+                std::size_t best = quietIndex_;
+                for (std::size_t i = quietIndex_ + 1; i < buffer_.moves.size(); ++i) {
+                    if (buffer_.scores[i] > buffer_.scores[best]) best = i;
+                }
+                if (best != quietIndex_) {
+                    Move m = buffer_.moves[best];
+                    buffer_.moves[best] = buffer_.moves[quietIndex_];
+                    buffer_.moves[quietIndex_] = m;
+                    int sc = buffer_.scores[best];
+                    buffer_.scores[best] = buffer_.scores[quietIndex_];
+                    buffer_.scores[quietIndex_] = sc;
+                }
+                const Move m = buffer_.moves[quietIndex_++];
+                if (tryYield(m, out)) {
+                    yieldedFrom_ = Stage::Quiet;
+                    return true;
+                }
+            }
+            stage_ = Stage::Done;
+            // fall through
+        case Stage::Done:
+        default:
+            return false;
+    }
+}
+
+} // namespace gomoku
@@ -0,0 +1,228 @@
+// opening_book.cpp
+// Memory-mapped OpeningBook and its builder.
+
+#include "search/opening_book.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define GOMOKU_BOOK_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace gomoku {
+
+namespace {
+
+constexpr char          kMagic[8] = {'G', 'M', 'K', 'B', 'O', 'O', 'K', '1'};
+constexpr std::uint32_t kVersion  = 1;
+
+struct BookHeader {
+    char          magic[8];
+    std::uint32_t version;
+    std::uint32_t recordSize;
+    std::uint64_t count;
+    std::uint64_t reserved;
+};
+static_assert(sizeof(BookHeader) == 32, "book header is 32 bytes");
+
+// Records sort by key, then most visited first.
+inline bool recordBefore(const BookRecord& a, const BookRecord& b) {
+    if (a.key != b.key) return a.key < b.key;
+    if (a.visits != b.visits) return a.visits > b.visits;
+    return a.cell < b.cell;
+}
+
+inline bool validHeader(const BookHeader& h, std::size_t fileSize) {
+    return std::memcmp(h.magic, kMagic, sizeof(kMagic)) == 0 &&
+           h.version == kVersion &&
+           h.recordSize == sizeof(BookRecord) &&
+           h.count <= (fileSize - sizeof(BookHeader)) / sizeof(BookRecord);
+}
+
+} // namespace
+
+//------------------------------------------------------------------------------
+// OpeningBook
+//------------------------------------------------------------------------------
+
+OpeningBook::~OpeningBook() {
+    close();
+}
+
+bool OpeningBook::open(const std::string& path) {
+    close();
+#if defined(GOMOKU_BOOK_MMAP)
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(BookHeader)) {
+        ::close(fd);
+        return false;
+    }
+    const std::size_t size = static_cast<std::size_t>(st.st_size);
+    void* mem = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);  // the mapping keeps the file open
+    if (mem == MAP_FAILED) return false;
+
+    BookHeader header;
+    std::memcpy(&header, mem, sizeof(header));
+    if (!validHeader(header, size)) {
+        munmap(mem, size);
+        return false;
+    }
+    mapping_     = mem;
+    mappingSize_ = size;
+    records_     = reinterpret_cast<const BookRecord*>(static_cast<const char*>(mem) + sizeof(BookHeader));
+    count_       = static_cast<std::size_t>(header.count);
+#else
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return false;
+    std::fseek(f, 0, SEEK_END);
+    const long len = std::ftell(f);
+    std::fseek(f, 0, SEEK_SET);
+    if (len < static_cast<long>(sizeof(BookHeader))) {
+        std::fclose(f);
+        return false;
+    }
+    buffer_.resize(static_cast<std::size_t>(len));
+    const bool ok = std::fread(buffer_.data(), 1, buffer_.size(), f) == buffer_.size();
+    std::fclose(f);
+    BookHeader header;
+    std::memcpy(&header, buffer_.data(), sizeof(header));
+    if (!ok || !validHeader(header, buffer_.size())) {
+        buffer_.clear();
+        return false;
+    }
+    records_ = reinterpret_cast<const BookRecord*>(buffer_.data() + sizeof(BookHeader));
+    count_   = static_cast<std::size_t>(header.count);
+#endif
+    return true;
+}
+
+void OpeningBook::close() {
+#if defined(GOMOKU_BOOK_MMAP)
+    if (mapping_) munmap(mapping_, mappingSize_);
+#endif
+    mapping_     = nullptr;
+    mappingSize_ = 0;
+    buffer_.clear();
+    records_ = nullptr;
+    count_   = 0;
+}
+
+void OpeningBook::findRange(std::uint64_t key, std::size_t& first, std::size_t& last) const {
+    const BookRecord* begin = records_;
+    const BookRecord* end   = records_ + count_;
+    const BookRecord* lo = std::lower_bound(begin, end, key,
+        [](const BookRecord& r, std::uint64_t k) { return r.key < k; });
+    const BookRecord* hi = lo;
+    while (hi != end && hi->key == key) ++hi;
+    first = static_cast<std::size_t>(lo - begin);
+    last  = static_cast<std::size_t>(hi - begin);
+}
+
+std::size_t OpeningBook::probe(const Board& board, BookMove* out, std::size_t maxMoves) const {
+    if (!records_) return 0;
+    int symmetry = 0;
+    const std::uint64_t key = board.getCanonicalKey(&symmetry);
+    std::size_t first = 0;
+    std::size_t last  = 0;
+    findRange(key, first, last);
+
+    std::size_t n = 0;
+    for (std::size_t i = first; i < last && n < maxMoves; ++i) {
+        const BookRecord& r = records_[i];
+        if (r.cell >= 144) continue;
+        out[n].move   = Board::inverseTransformMove(symmetry, Move(r.cell % 12, r.cell / 12));
+        out[n].score  = r.score;
+        out[n].visits = r.visits;
+        ++n;
+    }
+    return n;
+}
+
+bool OpeningBook::bestMove(const Board& board, BookMove& out) const {
+    BookMove moves[8];
+    const std::size_t n = probe(board, moves, 8);
+    for (std::size_t i = 0; i < n; ++i) {
+        if (!board.isOccupied(moves[i].move.x, moves[i].move.y)) {
+            out = moves[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+//------------------------------------------------------------------------------
+// OpeningBookBuilder
+//------------------------------------------------------------------------------
+
+void OpeningBookBuilder::add(const Board& board, const Move& move, int score,
+                             std::uint32_t visits) {
+    if (move.x < 0 || move.x >= 12 || move.y < 0 || move.y >= 12 || visits == 0) return;
+    int symmetry = 0;
+    BookRecord r;
+    r.key = board.getCanonicalKey(&symmetry);
+    const Move m = Board::transformMove(symmetry, move);
+    r.cell   = static_cast<std::uint8_t>(m.y * 12 + m.x);
+    r.score  = static_cast<std::int16_t>(std::max(-32767, std::min(32767, score)));
+    r.visits = visits;
+    addRecord(r);
+}
+
+void OpeningBookBuilder::add(const OpeningBook& book) {
+    for (std::size_t i = 0; i < book.size(); ++i) addRecord(book.records()[i]);
+}
+
+void OpeningBookBuilder::addRecord(const BookRecord& r) {
+    records_.push_back(r);
+}
+
+bool OpeningBookBuilder::write(const std::string& path, std::uint32_t minVisits) {
+    // Merge samples of the same (key, move).
+    std::sort(records_.begin(), records_.end(), [](const BookRecord& a, const BookRecord& b) {
+        return a.key != b.key ? a.key < b.key : a.cell < b.cell;
+    });
+    std::vector<BookRecord> merged;
+    merged.reserve(records_.size());
+    for (std::size_t i = 0; i < records_.size();) {
+        std::size_t j = i;
+        std::uint64_t visits = 0;
+        std::int64_t  weighted = 0;
+        for (; j < records_.size() && records_[j].key == records_[i].key &&
+               records_[j].cell == records_[i].cell; ++j) {
+            visits   += records_[j].visits;
+            weighted += static_cast<std::int64_t>(records_[j].score) * records_[j].visits;
+        }
+        BookRecord r = records_[i];
+        r.visits = static_cast<std::uint32_t>(std::min<std::uint64_t>(visits, 0xFFFFFFFFu));
+        r.score  = static_cast<std::int16_t>(weighted / static_cast<std::int64_t>(visits));
+        if (r.visits >= minVisits) merged.push_back(r);
+        i = j;
+    }
+    std::sort(merged.begin(), merged.end(), recordBefore);
+    records_ = merged;
+
+    std::FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) return false;
+    BookHeader header;
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version    = kVersion;
+    header.recordSize = sizeof(BookRecord);
+    header.count      = merged.size();
+    header.reserved   = 0;
+    bool ok = std::fwrite(&header, sizeof(header), 1, f) == 1;
+    if (ok && !merged.empty()) {
+        ok = std::fwrite(merged.data(), sizeof(BookRecord), merged.size(), f) == merged.size();
+    }
+    ok = (std::fclose(f) == 0) && ok;
+    return ok;
+}
+
+} // namespace gomoku
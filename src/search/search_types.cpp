@@ -0,0 +1,29 @@
+// search_types.cpp
+// Out-of-line parts of the shared search types.
+
+#include "search/search_types.h"
+#include "search/evaluator.h"
+#include "search/transposition_table.h"
+
+namespace gomoku {
+
+MoveGuard::MoveGuard(Board& board, const Move& move,
+                     IThreatSolver* threatSolver, const TranspositionTable* tt,
+                     IEvaluator* evaluator)
+    : board_(board), move_(move), threatSolver_(threatSolver), evaluator_(evaluator),
+      valid_(board_.makeMove(move.x, move.y)) {
+    if (!valid_) return;
+    if (tt) tt->prefetch(board_.getCanonicalKey());
+    if (threatSolver_) threatSolver_->notifyMove(move_);
+    if (evaluator_) evaluator_->notifyMove(move_);
+}
+
+MoveGuard::~MoveGuard() {
+    if (valid_) {
+        board_.unmakeMove(move_.x, move_.y);
+        if (threatSolver_) threatSolver_->notifyUndo(move_);
+        if (evaluator_) evaluator_->notifyUndo(move_);
+    }
+}
+
+} // namespace gomoku
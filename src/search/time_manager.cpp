@@ -0,0 +1,81 @@
+// time_manager.cpp
+// Wall-clock and node budget checks for SearchEngine.
+
+#include "search/time_manager.h"
+
+#include <algorithm>
+
+namespace gomoku {
+
+void TimeManager::start(const SearchLimits& limits) {
+    limits_    = limits;
+    startTime_ = Clock::now();
+    ownStop_.store(false, std::memory_order_relaxed);
+    stop_      = limits.stopToken ? limits.stopToken : &ownStop_;
+    ticks_     = 0;
+
+    panic_            = false;
+    haveIteration_    = false;
+    lastScore_        = 0;
+    stableIterations_ = 0;
+
+    if (limits.remainingTimeMs != 0) {
+        // Game clock: an even share of what is left, plus most of the
+        // increment; never more than a quarter of the clock.
+        const std::uint64_t usable = limits.remainingTimeMs > kMoveOverheadMs
+                                   ? limits.remainingTimeMs - kMoveOverheadMs : 1;
+        const std::uint64_t movesToGo =
+            static_cast<std::uint64_t>(limits.movesToGo > 0 ? limits.movesToGo : kDefaultMovesToGo);
+        const std::uint64_t share = usable / movesToGo + limits.incrementMs * 3 / 4;
+        const std::uint64_t cap   = std::max<std::uint64_t>(1, usable / 4);
+        hardMs_      = std::min(std::max<std::uint64_t>(1, share * 2), cap);
+        panicHardMs_ = std::min(hardMs_ + limits.panicExtraTimeMs, std::max(cap, usable / 2));
+        if (limits.timeLimitMs != 0) {
+            hardMs_      = std::min(hardMs_, limits.timeLimitMs);
+            panicHardMs_ = std::min(panicHardMs_, limits.timeLimitMs + limits.panicExtraTimeMs);
+        }
+    } else {
+        hardMs_      = limits.timeLimitMs;
+        panicHardMs_ = limits.timeLimitMs == 0 ? 0 : limits.timeLimitMs + limits.panicExtraTimeMs;
+    }
+    softMs_ = hardMs_ / 2;
+}
+
+bool TimeManager::checkStopCondition(std::uint64_t nodesVisited, bool inPanic) {
+    if (isStopped()) return true;
+    if (limits_.maxNodes != 0 && nodesVisited >= limits_.maxNodes) {
+        requestStop();
+        return true;
+    }
+    const bool panic = (inPanic || panic_) && limits_.enablePanicMode;
+    const std::uint64_t budget = panic ? panicHardMs_ : hardMs_;
+    if (budget != 0 && elapsedMs() >= budget) {
+        requestStop();
+    }
+    return isStopped();
+}
+
+void TimeManager::onIterationComplete(const Move& bestMove, EvalScore score) {
+    if (haveIteration_) {
+        stableIterations_ = (bestMove == lastBestMove_) ? stableIterations_ + 1 : 0;
+        if (score < lastScore_ - kPanicScoreDrop) panic_ = true;
+    }
+    haveIteration_ = true;
+    lastBestMove_  = bestMove;
+    lastScore_     = score;
+}
+
+bool TimeManager::canStartIteration() const {
+    if (softMs_ == 0) return true;
+    std::uint64_t soft = softMs_;
+    if (stableIterations_ >= kStableIterations) soft /= 2;
+    if (inPanic()) soft *= 2;
+    return elapsedMs() < std::min(soft, inPanic() ? panicHardMs_ : hardMs_);
+}
+
+std::uint64_t TimeManager::elapsedMs() const {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - startTime_).count());
+}
+
+} // namespace gomoku
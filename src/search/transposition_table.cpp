@@ -0,0 +1,247 @@
+// transposition_table.cpp
+// Implementation of the clustered TranspositionTable used by SearchEngine.
+
+#include "search/transposition_table.h"
+
+#include <algorithm>
+#include <new>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace gomoku {
+
+namespace {
+
+constexpr std::uint64_t kGenerationMask = 0x3F;
+constexpr std::uint8_t  kNoMoveIndex    = 0xFF;
+
+// Bound codes; 0 marks an empty slot.
+constexpr std::uint64_t kBoundEmpty = 0;
+
+inline std::uint64_t boundCode(TTNodeType t) {
+    switch (t) {
+        case TTNodeType::Exact:      return 1;
+        case TTNodeType::LowerBound: return 2;
+        default:                     return 3;
+    }
+}
+
+inline TTNodeType boundType(std::uint64_t code) {
+    return code == 1 ? TTNodeType::Exact
+         : code == 2 ? TTNodeType::LowerBound : TTNodeType::UpperBound;
+}
+
+// 16-bit score packing.  Mate scores (within 1000 plies of kMateScore) map
+// onto the top of the int16 range; everything else is clamped.
+constexpr int kPackedMate = 32767;
+
+inline std::int16_t packScore(EvalScore s) {
+    if (s >= kMateThreshold)  return static_cast<std::int16_t>(kPackedMate - (kMateScore - s));
+    if (s <= -kMateThreshold) return static_cast<std::int16_t>(-kPackedMate + (kMateScore + s));
+    s = std::max(-TranspositionTable::kMaxStoredEval,
+                 std::min(TranspositionTable::kMaxStoredEval, s));
+    return static_cast<std::int16_t>(s);
+}
+
+inline EvalScore unpackScore(std::int16_t v) {
+    const int limit = kPackedMate - (kMateScore - kMateThreshold);
+    if (v >= limit)  return kMateScore - (kPackedMate - v);
+    if (v <= -limit) return -kMateScore + (kPackedMate + v);
+    return v;
+}
+
+struct Fields {
+    std::int16_t  value;
+    std::int16_t  eval;
+    std::uint8_t  depth;
+    std::uint8_t  generation;
+    std::uint64_t bound;
+    std::uint8_t  move;
+};
+
+inline std::uint64_t packData(const Fields& f) {
+    return  static_cast<std::uint64_t>(static_cast<std::uint16_t>(f.value))
+         | (static_cast<std::uint64_t>(static_cast<std::uint16_t>(f.eval)) << 16)
+         | (static_cast<std::uint64_t>(f.depth) << 32)
+         | (static_cast<std::uint64_t>((f.generation << 2) | f.bound) << 40)
+         | (static_cast<std::uint64_t>(f.move) << 48);
+}
+
+inline Fields unpackData(std::uint64_t d) {
+    Fields f;
+    f.value      = static_cast<std::int16_t>(d & 0xFFFF);
+    f.eval       = static_cast<std::int16_t>((d >> 16) & 0xFFFF);
+    f.depth      = static_cast<std::uint8_t>((d >> 32) & 0xFF);
+    f.generation = static_cast<std::uint8_t>((d >> 42) & kGenerationMask);
+    f.bound      = (d >> 40) & 0x3;
+    f.move       = static_cast<std::uint8_t>((d >> 48) & 0xFF);
+    return f;
+}
+
+constexpr std::size_t kHugePageSize = std::size_t(2) << 20;
+
+} // namespace
+
+TranspositionTable::TranspositionTable(std::size_t sizeMB) {
+    resize(sizeMB);
+}
+
+TranspositionTable::~TranspositionTable() {
+    release();
+}
+
+void TranspositionTable::resize(std::size_t sizeMB) {
+    // Round down to a power of two number of clusters so the index is a mask.
+    const std::size_t bytes = sizeMB << 20;
+    std::size_t clusters = 1;
+    while (clusters * 2 * sizeof(Cluster) <= bytes) clusters *= 2;
+    if (clusters == clusterCount_) return;
+    release();
+    allocate(clusters);
+    clear();
+}
+
+void TranspositionTable::allocate(std::size_t clusterCount) {
+    const std::size_t bytes = clusterCount * sizeof(Cluster);
+    alignment_ = (bytes >= kHugePageSize) ? kHugePageSize : alignof(Cluster);
+    void* mem = ::operator new(bytes, std::align_val_t(alignment_));
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    if (alignment_ == kHugePageSize) {
+        // Advisory only: failure just leaves the table on normal pages.
+        madvise(mem, bytes, MADV_HUGEPAGE);
+    }
+#endif
+    clusters_ = static_cast<Cluster*>(mem);
+    for (std::size_t i = 0; i < clusterCount; ++i) new (&clusters_[i]) Cluster;
+    clusterCount_ = clusterCount;
+    mask_         = clusterCount - 1;
+}
+
+void TranspositionTable::release() {
+    if (!clusters_) return;
+    // Cluster is trivially destructible; only the storage is released.
+    ::operator delete(clusters_, std::align_val_t(alignment_));
+    clusters_     = nullptr;
+    clusterCount_ = 0;
+    mask_         = 0;
+}
+
+void TranspositionTable::clear() {
+    for (std::size_t i = 0; i < clusterCount_; ++i) {
+        for (PackedEntry& e : clusters_[i].entries) {
+            e.check.store(0, std::memory_order_relaxed);
+            e.data.store(0, std::memory_order_relaxed);
+        }
+    }
+    generation_ = 0;
+}
+
+void TranspositionTable::newSearch() {
+    generation_ = static_cast<std::uint8_t>((generation_ + 1) & kGenerationMask);
+}
+
+bool TranspositionTable::probe(std::uint64_t key, TTEntry& out) const {
+    const Cluster& c = clusterOf(key);
+    for (const PackedEntry& e : c.entries) {
+        const std::uint64_t data  = e.data.load(std::memory_order_relaxed);
+        const std::uint64_t check = e.check.load(std::memory_order_relaxed);
+        if ((check ^ data) != key) continue;
+        Fields f = unpackData(data);
+        if (f.bound == kBoundEmpty) continue;
+        out.key   = key;
+        out.value = unpackScore(f.value);
+        out.eval  = unpackScore(f.eval);
+        out.depth = f.depth;
+        out.type  = boundType(f.bound);
+        out.bestMove = (f.move == kNoMoveIndex) ? Move(-1, -1) : Move(f.move % 12, f.move / 12);
+        return true;
+    }
+    return false;
+}
+
+void TranspositionTable::store(std::uint64_t key,
+                               EvalScore     value,
+                               EvalScore     eval,
+                               int           depth,
+                               TTNodeType    type,
+                               const Move&   bestMove) {
+    Cluster& c = clusterOf(key);
+
+    // Pick the slot: same key, else empty, else the shallowest / oldest.
+    PackedEntry*  slot = nullptr;
+    std::uint64_t slotData = 0;
+    std::uint64_t slotCheck = 0;
+    int worst = 0;
+    for (PackedEntry& e : c.entries) {
+        const std::uint64_t data  = e.data.load(std::memory_order_relaxed);
+        const std::uint64_t check = e.check.load(std::memory_order_relaxed);
+        Fields f = unpackData(data);
+        if ((check ^ data) == key || f.bound == kBoundEmpty) {
+            slot = &e;
+            slotData = data;
+            slotCheck = check;
+            break;
+        }
+        int age = (generation_ - f.generation) & static_cast<int>(kGenerationMask);
+        int merit = f.depth - 8 * age;
+        if (!slot || merit < worst) {
+            slot = &e;
+            slotData = data;
+            slotCheck = check;
+            worst = merit;
+        }
+    }
+
+    Move move = bestMove;
+    if ((slotCheck ^ slotData) == key) {
+        Fields old = unpackData(slotData);
+        // Keep a deeper bound of the same search; an exact score always wins.
+        if (old.generation == generation_ && old.depth > depth && type != TTNodeType::Exact) return;
+        // Keep the old best move if this result has none.
+        if ((move.x < 0 || move.y < 0) && old.move != kNoMoveIndex) {
+            move = Move(old.move % 12, old.move / 12);
+        }
+    }
+
+    Fields f;
+    f.value      = packScore(value);
+    f.eval       = packScore(eval);
+    f.depth      = static_cast<std::uint8_t>(std::max(0, std::min(depth, 255)));
+    f.generation = generation_;
+    f.bound      = boundCode(type);
+    f.move       = (move.x >= 0 && move.x < 12 && move.y >= 0 && move.y < 12)
+                 ? static_cast<std::uint8_t>(move.y * 12 + move.x) : kNoMoveIndex;
+    const std::uint64_t data = packData(f);
+    slot->data.store(data, std::memory_order_relaxed);
+    slot->check.store(key ^ data, std::memory_order_relaxed);
+}
+
+int TranspositionTable::hashfull() const {
+    const std::size_t sample = std::min<std::size_t>(clusterCount_, 1000);
+    if (sample == 0) return 0;
+    std::size_t used = 0;
+    for (std::size_t i = 0; i < sample; ++i) {
+        for (const PackedEntry& e : clusters_[i].entries) {
+            const Fields f = unpackData(e.data.load(std::memory_order_relaxed));
+            if (f.bound != kBoundEmpty && f.generation == generation_) ++used;
+        }
+    }
+    return static_cast<int>(used * 1000 / (sample * kClusterSize));
+}
+
+EvalScore TranspositionTable::toTTScore(EvalScore score, int plyFromRoot) {
+    // Store mate scores as distance from this node, not from the root.
+    if (score >= kMateThreshold)  return score + plyFromRoot;
+    if (score <= -kMateThreshold) return score - plyFromRoot;
+    return score;
+}
+
+EvalScore TranspositionTable::fromTTScore(EvalScore score, int plyFromRoot) {
+    if (score >= kMateThreshold)  return score - plyFromRoot;
+    if (score <= -kMateThreshold) return score + plyFromRoot;
+    return score;
+}
+
+} // namespace gomoku
@@ -0,0 +1,388 @@
+// dfpn_solver.cpp
+//
+// Implementation of DfpnSolver (see dfpn_solver.h).
+//
+//   - ProofTable: bucketed pn/dn table with work-based replacement and
+//     garbage collection.
+//   - Impl::mid(): Nagai's multiple iterative deepening with the 1+ε trick
+//     (a child may run until its number exceeds the second-best sibling's
+//     by a quarter), which avoids most of the re-expansions of plain df-pn.
+//   - Move generation uses the ThreatSolver threat board, kept in sync with
+//     the working board by notifyMove()/notifyUndo().
+
+#include "dfpn_solver.h"
+#include "threat_cache.h"
+#include "threat_solver.h"
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+namespace gomoku {
+
+namespace {
+
+using ProofNumber = std::uint32_t;
+
+constexpr ProofNumber kInfinitePN = 0x7FFFFFFF;
+
+// Poll the clock and the abort flag every 1024 expansions.
+constexpr std::uint64_t kPollMask = 1023;
+
+inline ProofNumber addPN(ProofNumber a, ProofNumber b) {
+    const std::uint64_t s = static_cast<std::uint64_t>(a) + b;
+    return s >= kInfinitePN ? kInfinitePN - 1 : static_cast<ProofNumber>(s);
+}
+
+inline Player otherPlayer(Player p) {
+    return (p == Player::Black) ? Player::White : Player::Black;
+}
+
+//------------------------------------------------------------------------------
+// ProofTable
+//------------------------------------------------------------------------------
+
+class ProofTable {
+public:
+    static constexpr int kBucketSize = 4;
+
+    explicit ProofTable(std::size_t sizeMB) {
+        std::size_t buckets = 1;
+        while ((buckets * 2) * kBucketSize * sizeof(Entry) <= (sizeMB << 20)) buckets *= 2;
+        entries_.assign(buckets * kBucketSize, Entry{});
+        mask_ = buckets - 1;
+    }
+
+    bool probe(std::uint64_t key, ProofNumber& pn, ProofNumber& dn) const {
+        const Entry* b = bucketOf(key);
+        for (int i = 0; i < kBucketSize; ++i) {
+            if (b[i].key == key) {
+                pn = b[i].pn;
+                dn = b[i].dn;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void store(std::uint64_t key, ProofNumber pn, ProofNumber dn, std::uint64_t work) {
+        // Same key, else an empty slot, else the entry with the least work.
+        Entry* b = bucketOf(key);
+        Entry* slot = &b[0];
+        for (int i = 0; i < kBucketSize; ++i) {
+            if (b[i].key == key) {
+                slot = &b[i];
+                break;
+            }
+            if (slot->key != 0 && (b[i].key == 0 || b[i].work < slot->work)) slot = &b[i];
+        }
+        if (slot->key == 0) ++used_;
+        slot->key  = key;
+        slot->pn   = pn;
+        slot->dn   = dn;
+        slot->work = static_cast<std::uint32_t>(std::min<std::uint64_t>(work, 0xFFFFFFFFu));
+        if (used_ * 10 > entries_.size() * 9) collectGarbage();
+    }
+
+    void clear() {
+        std::fill(entries_.begin(), entries_.end(), Entry{});
+        used_ = 0;
+    }
+
+    std::size_t capacity() const { return entries_.size(); }
+    std::size_t used() const { return used_; }
+
+private:
+    struct Entry {
+        std::uint64_t key  = 0;  // 0 marks an empty slot
+        ProofNumber   pn   = 0;
+        ProofNumber   dn   = 0;
+        std::uint32_t work = 0;  // expansions spent below the node
+        std::uint32_t pad  = 0;
+    };
+
+    Entry* bucketOf(std::uint64_t key) { return &entries_[(key & mask_) * kBucketSize]; }
+    const Entry* bucketOf(std::uint64_t key) const { return &entries_[(key & mask_) * kBucketSize]; }
+
+    // Drop the cheapest subtrees (work <= threshold, threshold doubling)
+    // until at most half of the table is in use.
+    void collectGarbage() {
+        for (std::uint32_t threshold = 1; used_ * 2 > entries_.size(); threshold *= 2) {
+            for (Entry& e : entries_) {
+                if (e.key != 0 && e.work <= threshold) {
+                    e = Entry{};
+                    --used_;
+                }
+            }
+            if (threshold >= 0x80000000u) break;
+        }
+    }
+
+    std::vector<Entry> entries_;
+    std::size_t        mask_ = 0;
+    std::size_t        used_ = 0;
+};
+
+// Results of the two defence models never share an entry.
+constexpr std::uint64_t kFullWidthSalt = 0xC2B2AE3D27D4EB4FULL;
+
+inline std::uint64_t tableKey(const Board& board, Player attacker, bool fullWidth) {
+    const std::uint64_t key = ThreatCache::keyOf(board.getHashKey(), attacker);
+    return fullWidth ? key ^ kFullWidthSalt : key;
+}
+
+// Moves of one node and the table keys of the positions they lead to.
+struct PlyBuffer {
+    MoveList      moves;
+    std::uint64_t keys[MoveList::capacity()];
+};
+
+} // namespace
+
+//------------------------------------------------------------------------------
+// DfpnSolver::Impl
+//------------------------------------------------------------------------------
+
+struct DfpnSolver::Impl {
+    explicit Impl(std::size_t tableMB)
+        : table(tableMB), threats(board), plies(MoveList::capacity() + 1) {}
+
+    ProofTable             table;
+    Board                  board;    // working copy of the position
+    ThreatSolver           threats;  // synced to 'board'
+    std::vector<PlyBuffer> plies;
+
+    Player     attacker = Player::Black;
+    DfpnLimits limits;
+    std::chrono::steady_clock::time_point start;
+    std::uint64_t nodes = 0;
+    bool          aborted = false;
+
+    std::uint64_t keyOfBoard() const {
+        return tableKey(board, attacker, limits.fullWidthDefence);
+    }
+
+    bool shouldAbort();
+
+    // Terminal test and move generation for the current node.  Returns true
+    // (with pn/dn set) if the node is decided without children.
+    bool expand(PlyBuffer& buf, ProofNumber& pn, ProofNumber& dn);
+
+    void mid(std::uint64_t key, int ply, ProofNumber thpn, ProofNumber thdn,
+             ProofNumber& pn, ProofNumber& dn);
+};
+
+bool DfpnSolver::Impl::shouldAbort() {
+    if (aborted) return true;
+    if (limits.maxNodes != 0 && nodes >= limits.maxNodes) {
+        aborted = true;
+    } else if ((nodes & kPollMask) == 0) {
+        if (limits.abortFlag && limits.abortFlag->load(std::memory_order_relaxed)) {
+            aborted = true;
+        } else if (limits.timeLimitMs != 0) {
+            const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start).count();
+            if (static_cast<std::uint64_t>(elapsed) >= limits.timeLimitMs) aborted = true;
+        }
+    }
+    return aborted;
+}
+
+bool DfpnSolver::Impl::expand(PlyBuffer& buf, ProofNumber& pn, ProofNumber& dn) {
+    const Player toMove  = board.sideToMove();
+    const bool   orNode  = (toMove == attacker);
+    const ProofNumber win[2]  = {0, kInfinitePN};  // {pn, dn} of a proof
+    const ProofNumber loss[2] = {kInfinitePN, 0};  // {pn, dn} of a disproof
+    const ProofNumber* toMoveWins  = orNode ? win : loss;
+    const ProofNumber* toMoveLoses = orNode ? loss : win;
+
+    ForcingMoves own;
+    ForcingMoves opp;
+    threats.collectForcingMoves(board, toMove, own);
+    buf.moves.clear();
+    if (!own.fives.empty()) {
+        pn = toMoveWins[0];
+        dn = toMoveWins[1];
+        return true;
+    }
+    threats.collectForcingMoves(board, otherPlayer(toMove), opp);
+    if (opp.fives.size() >= 2) {
+        pn = toMoveLoses[0];
+        dn = toMoveLoses[1];
+        return true;
+    }
+
+    if (opp.fives.size() == 1) {
+        buf.moves.push_back(opp.fives[0]);
+    } else if (orNode) {
+        buf.moves.insert(buf.moves.end(), own.fours.begin(), own.fours.end());
+        buf.moves.insert(buf.moves.end(), own.threes.begin(), own.threes.end());
+    } else if (!limits.fullWidthDefence && !opp.fours.empty()) {
+        // The attacker threatens a four: its four squares (the defence
+        // points of its threes) and the defender's own fours.
+        std::uint64_t seen[3] = {0ULL, 0ULL, 0ULL};
+        auto add = [&](const MoveList& list) {
+            for (const Move& m : list) {
+                const int idx = m.y * 12 + m.x;
+                if ((seen[idx >> 6] >> (idx & 63)) & 1ULL) continue;
+                seen[idx >> 6] |= 1ULL << (idx & 63);
+                buf.moves.push_back(m);
+            }
+        };
+        add(opp.fours);
+        add(own.fours);
+    } else {
+        for (const Move& m : board.emptyCells()) buf.moves.push_back(m);
+    }
+    if (buf.moves.empty()) {
+        // No forcing move left (OR) or a full board (AND): no win.
+        pn = loss[0];
+        dn = loss[1];
+        return true;
+    }
+
+    for (std::size_t i = 0; i < buf.moves.size(); ++i) {
+        const Move& m = buf.moves[i];
+        board.makeMove(m.x, m.y);
+        buf.keys[i] = keyOfBoard();
+        board.unmakeMove(m.x, m.y);
+    }
+    return false;
+}
+
+void DfpnSolver::Impl::mid(std::uint64_t key, int ply, ProofNumber thpn, ProofNumber thdn,
+                           ProofNumber& pn, ProofNumber& dn) {
+    ++nodes;
+    const std::uint64_t nodesAtStart = nodes;
+    PlyBuffer& buf = plies[ply];
+    if (expand(buf, pn, dn)) {
+        table.store(key, pn, dn, 1);
+        return;
+    }
+
+    const bool orNode = (board.sideToMove() == attacker);
+    for (;;) {
+        // Combine the children: OR takes the min pn and the sum of dn, AND
+        // the other way round.  'best' is the child to expand next.
+        std::size_t best = 0;
+        ProofNumber bestNum = kInfinitePN;
+        ProofNumber secondNum = kInfinitePN;
+        ProofNumber bestOther = 0;
+        ProofNumber sum = 0;
+        for (std::size_t i = 0; i < buf.moves.size(); ++i) {
+            ProofNumber cpn = 1;
+            ProofNumber cdn = 1;
+            table.probe(buf.keys[i], cpn, cdn);
+            const ProofNumber num   = orNode ? cpn : cdn;
+            const ProofNumber other = orNode ? cdn : cpn;
+            sum = (other == kInfinitePN) ? kInfinitePN
+                : (sum == kInfinitePN ? sum : addPN(sum, other));
+            if (num < bestNum) {
+                secondNum = bestNum;
+                bestNum   = num;
+                bestOther = other;
+                best      = i;
+            } else if (num < secondNum) {
+                secondNum = num;
+            }
+        }
+        pn = orNode ? bestNum : sum;
+        dn = orNode ? sum : bestNum;
+        if (pn >= thpn || dn >= thdn || shouldAbort()) break;
+
+        // Thresholds for the chosen child.
+        const ProofNumber th     = orNode ? thpn : thdn;
+        const ProofNumber thSum  = orNode ? thdn : thpn;
+        const ProofNumber epsilon = (secondNum == kInfinitePN)
+                                  ? kInfinitePN : addPN(secondNum, secondNum / 4 + 1);
+        const ProofNumber childTh = std::min(th, epsilon);
+        const std::uint64_t rest = static_cast<std::uint64_t>(thSum) -
+                                   (orNode ? dn : pn) + bestOther;
+        const ProofNumber childThSum = static_cast<ProofNumber>(
+            std::min<std::uint64_t>(rest, kInfinitePN));
+
+        const Move m = buf.moves[best];
+        board.makeMove(m.x, m.y);
+        threats.notifyMove(m);
+        ProofNumber cpn = 0;
+        ProofNumber cdn = 0;
+        if (orNode) mid(buf.keys[best], ply + 1, childTh, childThSum, cpn, cdn);
+        else        mid(buf.keys[best], ply + 1, childThSum, childTh, cpn, cdn);
+        board.unmakeMove(m.x, m.y);
+        threats.notifyUndo(m);
+    }
+    table.store(key, pn, dn, nodes - nodesAtStart + 1);
+}
+
+//------------------------------------------------------------------------------
+// DfpnSolver
+//------------------------------------------------------------------------------
+
+DfpnSolver::DfpnSolver(std::size_t tableMB) : impl_(new Impl(tableMB)) {}
+
+DfpnSolver::~DfpnSolver() = default;
+
+DfpnResult DfpnSolver::solve(const Board& board, Player attacker, const DfpnLimits& limits) {
+    Impl& s = *impl_;
+    s.board    = board;
+    s.threats.syncFromBoard(s.board);
+    s.attacker = attacker;
+    s.limits   = limits;
+    s.start    = std::chrono::steady_clock::now();
+    s.nodes    = 0;
+    s.aborted  = false;
+
+    ProofNumber pn = 0;
+    ProofNumber dn = 0;
+    s.mid(s.keyOfBoard(), 0, kInfinitePN, kInfinitePN, pn, dn);
+
+    DfpnResult result;
+    result.nodes  = s.nodes;
+    result.status = (pn == 0) ? DfpnStatus::Proven
+                  : (dn == 0) ? DfpnStatus::Disproven : DfpnStatus::Unknown;
+
+    // The root's children are still in plies[0] unless the root was terminal.
+    const bool orRoot = (s.board.sideToMove() == attacker);
+    const PlyBuffer& root = s.plies[0];
+    if ((orRoot && pn == 0) || (!orRoot && dn == 0)) {
+        for (std::size_t i = 0; i < root.moves.size(); ++i) {
+            ProofNumber cpn = 1;
+            ProofNumber cdn = 1;
+            if (s.table.probe(root.keys[i], cpn, cdn) && (orRoot ? cpn : cdn) == 0) {
+                result.bestMove = root.moves[i];
+                break;
+            }
+        }
+    }
+    if (orRoot && pn == 0 && result.bestMove.x < 0) {
+        // Decided without children: the attacker has a five to play.
+        ForcingMoves f;
+        s.threats.collectForcingMoves(s.board, attacker, f);
+        if (!f.fives.empty()) result.bestMove = f.fives[0];
+    }
+    return result;
+}
+
+DfpnStatus DfpnSolver::lookup(const Board& board, Player attacker, bool fullWidthDefence) const {
+    ProofNumber pn = 1;
+    ProofNumber dn = 1;
+    if (!impl_->table.probe(tableKey(board, attacker, fullWidthDefence), pn, dn)) {
+        return DfpnStatus::Unknown;
+    }
+    return pn == 0 ? DfpnStatus::Proven
+         : dn == 0 ? DfpnStatus::Disproven : DfpnStatus::Unknown;
+}
+
+void DfpnSolver::clear() {
+    impl_->table.clear();
+}
+
+std::size_t DfpnSolver::tableEntries() const {
+    return impl_->table.capacity();
+}
+
+std::size_t DfpnSolver::tableUsed() const {
+    return impl_->table.used();
+}
+
+} // namespace gomoku
@@ -0,0 +1,281 @@
+// pattern_table.cpp
+//
+// Construction of the shared 1-D threat pattern tables (see pattern_table.h).
+//
+// Everything here runs once at start-up.  The build enumerates every sub-line
+// length S ∈ [5,12] and every stone mask, classifies the threats in it by
+// brute force, and stores the results as byte pattern ids in flat arrays:
+//
+//   bestPatternAtCell_ : Σ 2^S · S bytes       ≈ 88 KB
+//   candidates_        : ≈ 2 bytes per threat  (plus 4-byte slot offsets)
+//
+// so the hot lookups used by ThreatBoard stay within L2.
+
+#include "pattern_table.h"
+#include "core/bit_utils.h"
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+namespace gomoku {
+
+namespace {
+
+inline int popcount16(uint32_t v) {
+    return popcount64(v);
+}
+
+constexpr uint32_t kWindowBits = (1U << GOMOKU_WIN_LENGTH) - 1U;
+
+// Bitmask of window start offsets w (0 <= w <= len-5) whose five cells hold
+// exactly the attacker stones 'stoneSet' out of 'stonesMask'.  If 'blocked'
+// is non-zero, windows touching any blocked cell are ignored.
+uint32_t waysOf(int len, uint32_t stonesMask, uint32_t stoneSet,
+                uint32_t blocked = 0U) {
+    uint32_t ways = 0U;
+    for (int w = 0; w + GOMOKU_WIN_LENGTH <= len; ++w) {
+        uint32_t window = kWindowBits << w;
+        if ((stonesMask & window) == stoneSet && (blocked & window) == 0U) {
+            ways |= 1U << w;
+        }
+    }
+    return ways;
+}
+
+uint32_t cellsOfWays(uint32_t ways) {
+    uint32_t cells = 0U;
+    for (int w = 0; ways >> w; ++w) {
+        if ((ways >> w) & 1U) cells |= kWindowBits << w;
+    }
+    return cells;
+}
+
+ThreatType classify(int a, int b) {
+    switch (a) {
+        case 5:  return ThreatType::Five;
+        case 4:  return b >= 2 ? ThreatType::OpenFour : ThreatType::SimpleFour;
+        case 3:  return b >= 3 ? ThreatType::OpenThree
+                     : (b == 2 ? ThreatType::BrokenThree : ThreatType::SimpleThree);
+        case 2:  return b >= 4 ? ThreatType::TwoFourWays
+                     : (b == 3 ? ThreatType::TwoThreeWays
+                     : (b == 2 ? ThreatType::TwoTwoWays : ThreatType::TwoOneWay));
+        case 1:  return b >= 5 ? ThreatType::OneFiveWays
+                     : (b == 4 ? ThreatType::OneFourWays
+                     : (b == 3 ? ThreatType::OneThreeWays
+                     : (b == 2 ? ThreatType::OneTwoWays : ThreatType::OneOneWay)));
+        default: return ThreatType::None;
+    }
+}
+
+// Threat formed by stone set T inside sub-line (len, stonesMask), expressed
+// in sub-line coordinates.  'anchor' receives the window start.
+ThreatPattern describe(int len, uint32_t stonesMask, uint32_t stoneSet,
+                       int& anchor) {
+    ThreatPattern p;
+    anchor = -1;
+    uint32_t ways = waysOf(len, stonesMask, stoneSet);
+    if (ways == 0U || stoneSet == 0U) return p;
+
+    int a = popcount16(stoneSet);
+    int b = popcount16(ways);
+    uint32_t cells   = cellsOfWays(ways);
+    uint32_t empties = cells & ~stonesMask;
+    uint32_t defense = 0U;
+    uint32_t finish  = 0U;
+
+    p.type = classify(a, b);
+    if (a == 4) {
+        // Every way has exactly one empty square: it both completes the five
+        // and is the only place to stop that way.
+        finish  = empties;
+        defense = empties;
+    } else if (a == 3 && b >= 2) {
+        // Forcing three: finishing squares make an open four (two ways of four
+        // stones); a defense point leaves no such square.
+        for (int f = 0; f < len; ++f) {
+            uint32_t fb = 1U << f;
+            if (!(empties & fb)) continue;
+            if (popcount16(waysOf(len, stonesMask | fb, stoneSet | fb)) >= 2) {
+                finish |= fb;
+            }
+        }
+        for (int d = 0; d < len; ++d) {
+            uint32_t db = 1U << d;
+            if (!(empties & db)) continue;
+            bool defended = true;
+            for (int f = 0; f < len && defended; ++f) {
+                uint32_t fb = 1U << f;
+                if (!(empties & fb) || f == d) continue;
+                if (popcount16(waysOf(len, stonesMask | fb, stoneSet | fb, db)) >= 2) {
+                    defended = false;
+                }
+            }
+            if (defended) defense |= db;
+        }
+    }
+
+    int lo = 0;
+    while (!((cells >> lo) & 1U)) ++lo;
+    int hi = len - 1;
+    while (!((cells >> hi) & 1U)) --hi;
+
+    anchor = lo;
+    p.windowLen     = static_cast<uint8_t>(hi - lo + 1);
+    p.stonesMask    = static_cast<uint16_t>(stoneSet >> lo);
+    p.emptyMask     = static_cast<uint16_t>(empties >> lo);
+    p.defenseMask   = static_cast<uint16_t>(defense >> lo);
+    p.finishingMask = static_cast<uint16_t>(finish >> lo);
+    p.a = static_cast<uint8_t>(a);
+    p.b = static_cast<uint8_t>(b);
+    return p;
+}
+
+bool sameShape(const ThreatPattern& x, const ThreatPattern& y) {
+    return x.type == y.type && x.windowLen == y.windowLen &&
+           x.stonesMask == y.stonesMask && x.emptyMask == y.emptyMask &&
+           x.defenseMask == y.defenseMask && x.finishingMask == y.finishingMask;
+}
+
+// Distinct attacker stone sets (one per 5-window) in a sub-line.
+int stoneSetsOf(int len, uint32_t stonesMask, uint32_t (&out)[8]) {
+    int n = 0;
+    for (int w = 0; w + GOMOKU_WIN_LENGTH <= len; ++w) {
+        uint32_t set = stonesMask & (kWindowBits << w);
+        if (set == 0U) continue;
+        bool seen = false;
+        for (int i = 0; i < n && !seen; ++i) seen = (out[i] == set);
+        if (!seen) out[n++] = set;
+    }
+    return n;
+}
+
+} // namespace
+
+//------------------------------------------------------------------------------
+// Construction
+//------------------------------------------------------------------------------
+
+const PatternTable& PatternTable::instance() {
+    static PatternTable table;
+    static std::once_flag once;
+    std::call_once(once, [&]() {
+        table.initializeOnce();
+    });
+    return table;
+}
+
+void PatternTable::initializeOnce() {
+    if (!patterns_.empty()) return; // already initialized
+
+    using ShapeKey = std::tuple<uint8_t, uint8_t, uint16_t, uint16_t, uint16_t, uint16_t>;
+    std::map<ShapeKey, uint8_t> ids;
+    patterns_.assign(1, ThreatPattern{}); // id 0 = kNoPattern
+
+    auto idOf = [&](const ThreatPattern& p) -> uint8_t {
+        ShapeKey key(static_cast<uint8_t>(p.type), p.windowLen, p.stonesMask,
+                     p.emptyMask, p.defenseMask, p.finishingMask);
+        auto it = ids.find(key);
+        if (it != ids.end()) return it->second;
+        uint8_t id = static_cast<uint8_t>(patterns_.size());
+        ThreatPattern stored = p;
+        stored.patternId = id;
+        patterns_.push_back(stored);
+        ids.emplace(key, id);
+        return id;
+    };
+
+    // Slot layout.
+    uint32_t bestSize = 0;
+    uint32_t slots    = 0;
+    for (int len = kMinSubLine; len <= kMaxSubLine; ++len) {
+        bestBase_[len]      = bestSize;
+        candidateBase_[len] = slots;
+        bestSize += (1U << len) * static_cast<uint32_t>(len);
+        slots    += 1U << len;
+    }
+    bestPatternAtCell_.assign(bestSize, kNoPattern);
+    candidateBegin_.assign(slots + 1, 0U);
+    candidates_.clear();
+
+    for (int len = kMinSubLine; len <= kMaxSubLine; ++len) {
+        const uint32_t full = 1U << len;
+        for (uint32_t mask = 0; mask < full; ++mask) {
+            // Existing maximal threats.
+            uint32_t sets[8];
+            int n = stoneSetsOf(len, mask, sets);
+            PatternRef refs[8];
+            int refCount = 0;
+            for (int i = 0; i < n; ++i) {
+                bool maximal = true;
+                for (int j = 0; j < n && maximal; ++j) {
+                    if (j != i && (sets[i] & sets[j]) == sets[i]) maximal = false;
+                }
+                if (!maximal) continue;
+                int anchor;
+                ThreatPattern p = describe(len, mask, sets[i], anchor);
+                if (p.type == ThreatType::None) continue;
+                refs[refCount].patternId = idOf(p);
+                refs[refCount].anchor    = static_cast<uint8_t>(anchor);
+                ++refCount;
+            }
+            std::stable_sort(refs, refs + refCount,
+                             [&](const PatternRef& x, const PatternRef& y) {
+                                 return patterns_[x.patternId].type <
+                                        patterns_[y.patternId].type;
+                             });
+            candidateBegin_[candidateBase_[len] + mask] =
+                static_cast<uint32_t>(candidates_.size());
+            candidates_.insert(candidates_.end(), refs, refs + refCount);
+
+            // Best threat created by a move on each empty cell.
+            for (int c = 0; c < len; ++c) {
+                uint32_t cb = 1U << c;
+                if (mask & cb) continue;
+                uint32_t after = mask | cb;
+                ThreatPattern best;
+                for (int w = std::max(0, c - GOMOKU_WIN_LENGTH + 1);
+                     w <= c && w + GOMOKU_WIN_LENGTH <= len; ++w) {
+                    int anchor;
+                    ThreatPattern p = describe(len, after, after & (kWindowBits << w), anchor);
+                    if (p.type == ThreatType::None) continue;
+                    if (best.type == ThreatType::None || p.type < best.type) {
+                        best = p;
+                    }
+                }
+                if (best.type != ThreatType::None) {
+                    bestPatternAtCell_[bestBase_[len] + mask * len + c] = idOf(best);
+                }
+            }
+        }
+    }
+    candidateBegin_[slots] = static_cast<uint32_t>(candidates_.size());
+    candidates_.shrink_to_fit();
+}
+
+//------------------------------------------------------------------------------
+// Queries
+//------------------------------------------------------------------------------
+
+int PatternTable::findAnchor(int len, uint32_t stonesMask,
+                             uint8_t patternId, int cell) const {
+    if (patternId == kNoPattern) return -1;
+    const ThreatPattern& p = patterns_[patternId];
+    const uint32_t region = (1U << p.windowLen) - 1U;
+    int first = std::max(0, cell - p.windowLen + 1);
+    int last  = std::min(cell, len - p.windowLen);
+    for (int a = first; a <= last; ++a) {
+        if (((stonesMask >> a) & region) != p.stonesMask) continue;
+        if (!((p.stonesMask >> (cell - a)) & 1U)) continue;
+        // The window content matches; confirm the ways agree too, since they
+        // also depend on cells just outside the window.
+        int anchor;
+        ThreatPattern q = describe(len, stonesMask,
+                                   static_cast<uint32_t>(p.stonesMask) << a, anchor);
+        if (anchor == a && sameShape(p, q)) return a;
+    }
+    return -1;
+}
+
+} // namespace gomoku
@@ -0,0 +1,132 @@
+// threat_cache.cpp
+//
+// Lock-free ThreatAnalysis cache (see threat_cache.h).
+//
+// Payload encoding (7 words, one byte per move, cell = y*12 + x, 0xFF = none):
+//
+//   word 1      : nodeBudget (32) | flags (8) | firstWinningMove (8)
+//                 | winningLine size (8) | defensiveMoves size (8)
+//   words 2..4  : winningLine, up to 24 cells
+//   words 5..7  : defensiveMoves, up to 24 cells
+
+#include "threat_cache.h"
+
+namespace gomoku {
+
+namespace {
+
+constexpr uint8_t kNoCell = 0xFF;
+constexpr uint64_t kFlagForcedWin = 1ULL;
+
+// Keys are never 0 in practice; 0 marks an empty slot and is never matched.
+constexpr uint64_t kWhiteAttackerSalt = 0x9D39247E33776D41ULL;
+
+inline uint8_t cellOf(const Move& m) {
+    return static_cast<uint8_t>(m.y * 12 + m.x);
+}
+
+inline Move moveOf(uint8_t cell) {
+    return Move(cell % 12, cell / 12);
+}
+
+inline void putByte(uint64_t* words, int i, uint8_t v) {
+    words[i >> 3] |= static_cast<uint64_t>(v) << ((i & 7) * 8);
+}
+
+inline uint8_t getByte(const uint64_t* words, int i) {
+    return static_cast<uint8_t>(words[i >> 3] >> ((i & 7) * 8));
+}
+
+} // namespace
+
+ThreatCache::ThreatCache(std::size_t entries) {
+    std::size_t size = 1;
+    while (size * 2 <= entries) size *= 2;
+    table_.reset(new Entry[size]);
+    mask_ = size - 1;
+    clear();
+}
+
+uint64_t ThreatCache::keyOf(uint64_t boardHash, Player attacker) {
+    return (attacker == Player::White) ? boardHash ^ kWhiteAttackerSalt : boardHash;
+}
+
+bool ThreatCache::probe(uint64_t key, int nodeBudget, ThreatAnalysis& out) const {
+    const Entry& e = table_[key & mask_];
+    uint64_t w[1 + kPayloadWords];
+    uint64_t check = 0ULL;
+    for (int i = 0; i < 1 + kPayloadWords; ++i) {
+        w[i] = e.words[i].load(std::memory_order_relaxed);
+        check ^= w[i];
+    }
+    // check == key iff word 0 was written together with this payload.
+    const uint32_t budget = static_cast<uint32_t>(w[1]);
+    if (key == 0ULL || check != key || static_cast<int64_t>(budget) < nodeBudget) {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    const uint64_t* line = &w[2];
+    const uint64_t* defs = &w[5];
+    const int flags     = static_cast<int>((w[1] >> 32) & 0xFF);
+    const int firstCell = static_cast<int>((w[1] >> 40) & 0xFF);
+    const int lineCount = static_cast<int>((w[1] >> 48) & 0xFF);
+    const int defCount  = static_cast<int>((w[1] >> 56) & 0xFF);
+
+    out = ThreatAnalysis{};
+    out.attackerHasForcedWin = (flags & kFlagForcedWin) != 0;
+    if (firstCell != kNoCell) out.firstWinningMove = moveOf(static_cast<uint8_t>(firstCell));
+    for (int i = 0; i < lineCount; ++i) out.winningLine.push_back(moveOf(getByte(line, i)));
+    for (int i = 0; i < defCount; ++i) out.defensiveMoves.push_back(moveOf(getByte(defs, i)));
+
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void ThreatCache::store(uint64_t key, int nodeBudget, const ThreatAnalysis& analysis) {
+    if (key == 0ULL || nodeBudget < 0) return;
+    const int lineCount = static_cast<int>(analysis.winningLine.size());
+    const int defCount  = static_cast<int>(analysis.defensiveMoves.size());
+    if (lineCount > kMaxLineMoves || defCount > kMaxDefenseMoves) return;
+
+    uint64_t w[1 + kPayloadWords] = {};
+    const uint64_t first = analysis.attackerHasForcedWin
+                         ? cellOf(analysis.firstWinningMove) : kNoCell;
+    w[1] = static_cast<uint64_t>(static_cast<uint32_t>(nodeBudget))
+         | ((analysis.attackerHasForcedWin ? kFlagForcedWin : 0ULL) << 32)
+         | (first << 40)
+         | (static_cast<uint64_t>(lineCount) << 48)
+         | (static_cast<uint64_t>(defCount) << 56);
+    for (int i = 0; i < lineCount; ++i) putByte(&w[2], i, cellOf(analysis.winningLine[i]));
+    for (int i = 0; i < defCount; ++i)  putByte(&w[5], i, cellOf(analysis.defensiveMoves[i]));
+
+    w[0] = key;
+    for (int i = 1; i < 1 + kPayloadWords; ++i) w[0] ^= w[i];
+
+    Entry& e = table_[key & mask_];
+    for (int i = 0; i < 1 + kPayloadWords; ++i) {
+        e.words[i].store(w[i], std::memory_order_relaxed);
+    }
+}
+
+void ThreatCache::clear() {
+    for (std::size_t i = 0; i <= mask_; ++i) {
+        for (int j = 0; j < 1 + kPayloadWords; ++j) {
+            table_[i].words[j].store(0ULL, std::memory_order_relaxed);
+        }
+    }
+}
+
+ThreatCacheStats ThreatCache::stats() const {
+    ThreatCacheStats s;
+    s.hits   = hits_.load(std::memory_order_relaxed);
+    s.misses = misses_.load(std::memory_order_relaxed);
+    return s;
+}
+
+void ThreatCache::resetStats() {
+    hits_.store(0, std::memory_order_relaxed);
+    misses_.store(0, std::memory_order_relaxed);
+}
+
+} // namespace gomoku
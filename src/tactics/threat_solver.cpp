@@ -1,23 +1,26 @@
 // threat_solver.cpp
 //
-// Simplified, fully-compilable implementation of ThreatSolver.
+// Implementation of ThreatSolver.
 //
-// NOTE: This is a *minimal functional* implementation:
-//   - It keeps ThreatSolver in sync with Board.
-//   - It detects immediate winning moves (one move to make five).
-//   - computeDefensiveSet handles immediate one-move wins and double threats.
-//   - ThreatBoard and PatternTable are implemented as stubs (no advanced
-//     pattern recognition yet).
-//
-// This is a good starting point that can be extended later with the full
-// Victor Allis style dependency-based threat search.
+//   - ThreatBoard classifies every (player, cell, direction) with a single
+//     PatternTable lookup (see pattern_table.h) and is kept in sync with
+//     Board incrementally.
+//   - findWinningThreatSequence runs Allis' dependency-based search
+//     (dependency + combination stages) under the all-defenses assumption.
+//   - computeDefensiveSet tests the squares that can refute a found winning
+//     sequence, plus the defender's own forcing moves.
 //
 
 #include "threat_solver.h"
+#include "pattern_table.h"
+#include "core/bit_utils.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstring>
+#include <memory>
 #include <mutex>
+#include <thread>
 
 namespace gomoku {
 
@@ -43,341 +46,1181 @@ static inline bool onBoard(int x, int y) {
 }
 
 //------------------------------------------------------------------------------
-// ThreatSolver::RotatedBitboards
+// ThreatBoard
 //------------------------------------------------------------------------------
-// Current simplified implementation:
-//   - We only store a basic bitboard per player in direction index 0.
-//   - Other directions and extractLine() are essentially unused stubs.
-//   - All higher-level logic reads directly from Board, so this is just to
-//     satisfy the interface and keep future extensibility.
+// Per-cell, per-direction threat information for both players.  Line contents
+// are read straight from Board's line bitboards (Board::getLine), which Board
+// keeps up to date in every mutator, so there is no rotated copy to rebuild.
 //
 
-void ThreatSolver::RotatedBitboards::setStone(Player p, int x, int y) {
-    int pIdx = playerIndex(p);
-    int idx  = boardIndex(x, y);
-    int chunk = idx >> 6;
-    int offset = idx & 63;
-    bb[pIdx][0][chunk] |= (uint64_t(1) << offset);
-}
+namespace {
 
-void ThreatSolver::RotatedBitboards::clearStone(Player p, int x, int y) {
-    int pIdx = playerIndex(p);
-    int idx  = boardIndex(x, y);
-    int chunk = idx >> 6;
-    int offset = idx & 63;
-    bb[pIdx][0][chunk] &= ~(uint64_t(1) << offset);
-}
+struct ThreatCell {
+    ThreatType type = ThreatType::None;
+    uint8_t patternId = PatternTable::kNoPattern;
+};
 
-uint32_t ThreatSolver::RotatedBitboards::extractLine(Player p,
-                                                     Direction /*dir*/,
-                                                     int /*lineId*/,
-                                                     int& outLen) const {
-    // Minimal stub: we don't currently use this in the simplified solver.
-    outLen = 0;
-    (void)p;
-    return 0;
-}
+// Saved cell contents for undoing one incremental update.
+struct ThreatDelta {
+    uint16_t   slot;  // flat index into ThreatBoard::cells
+    ThreatCell old;
+};
 
-//------------------------------------------------------------------------------
-// ThreatSolver::ThreatBoard
-//------------------------------------------------------------------------------
+struct ThreatUndoFrame {
+    Move     move;
+    uint32_t firstDelta;
+};
+
+struct ThreatBoard {
+    // cells[player][y][x][dir]
+    ThreatCell cells[2][GOMOKU_BOARD_SIZE][GOMOKU_BOARD_SIZE][4];
+
+    // Undo stack for incrementalUpdate(): one frame per notified move, each
+    // owning at most 2 players × 4 directions × 9 cells of deltas.
+    std::vector<ThreatDelta>     deltas;
+    std::vector<ThreatUndoFrame> frames;
+
+    ThreatBoard() {
+        frames.reserve(GOMOKU_BOARD_SIZE * GOMOKU_BOARD_SIZE);
+        deltas.reserve(GOMOKU_BOARD_SIZE * GOMOKU_BOARD_SIZE * kMaxDeltasPerMove);
+    }
+
+    static constexpr int kRadius = GOMOKU_WIN_LENGTH - 1;
+    static constexpr int kMaxDeltasPerMove = 2 * 4 * (2 * kRadius + 1);
+
+    void clear();
+    void rebuild(const Board& board);
+
+    // Re-classify the cells within distance 4 of (x,y) on the four lines
+    // through it.  A cell's threat depends only on the cells within distance
+    // 4 of it along the line, so nothing else can change.  If recordUndo is
+    // set, the previous contents are pushed so undoUpdate() can restore them.
+    void incrementalUpdate(const Board& board, int x, int y, bool recordUndo);
+
+    // Restore the cells saved by the most recent recorded update of 'm'.
+    // Returns false (and changes nothing) if that update is not on top of
+    // the undo stack.
+    bool undoUpdate(const Move& m);
 
-void ThreatSolver::ThreatBoard::clear() {
+    // Re-classify the cells at offsets [lo, hi] of one line for player p.
+    void updateLine(const Board& board, int p, int dir, int lineId,
+                    int lo, int hi);
+};
+
+void ThreatBoard::clear() {
     std::memset(cells, 0, sizeof(cells));
+    deltas.clear();
+    frames.clear();
 }
 
-void ThreatSolver::ThreatBoard::rebuild(const RotatedBitboards& /*rbb*/) {
-    // Minimal implementation: clear and leave all threats as None.
+void ThreatBoard::updateLine(const Board& board, int p, int dir, int lineId,
+                             int lo, int hi) {
+    const PatternTable& table = PatternTable::instance();
+    const Player me  = (p == 0) ? Player::Black : Player::White;
+    const uint32_t own = board.getLine(me, dir, lineId);
+    const uint32_t opp = board.getLine(otherPlayer(me), dir, lineId);
+    const int len = Board::lineLength(dir, lineId);
+
+    // Walk the sub-lines between opponent stones; any threat lies inside one.
+    int o = lo;
+    while (o <= hi) {
+        if ((opp >> o) & 1U) {
+            Move c = Board::lineCell(dir, lineId, o);
+            cells[p][c.y][c.x][dir] = ThreatCell{};
+            ++o;
+            continue;
+        }
+        int start = o;
+        while (start > 0 && !((opp >> (start - 1)) & 1U)) --start;
+        int end = o + 1;
+        while (end < len && !((opp >> end) & 1U)) ++end;
+        const int sub = end - start;
+        const uint32_t stones = (own >> start) & ((1U << sub) - 1U);
+        for (; o < end && o <= hi; ++o) {
+            Move c = Board::lineCell(dir, lineId, o);
+            ThreatCell& cell = cells[p][c.y][c.x][dir];
+            cell.patternId = (sub >= PatternTable::kMinSubLine)
+                           ? table.bestPatternAtCell(sub, stones, o - start)
+                           : PatternTable::kNoPattern;
+            cell.type = table.pattern(cell.patternId).type;
+        }
+    }
+}
+
+void ThreatBoard::rebuild(const Board& board) {
     clear();
+    for (int p = 0; p < 2; ++p) {
+        for (int d = 0; d < 4; ++d) {
+            for (int line = 0; line < Board::lineCount(d); ++line) {
+                updateLine(board, p, d, line, 0, Board::lineLength(d, line) - 1);
+            }
+        }
+    }
 }
 
-void ThreatSolver::ThreatBoard::incrementalUpdate(const RotatedBitboards& rbb,
-                                                  int /*x*/, int /*y*/) {
-    // For now, just rebuild everything (still cheap on 12×12) or no-op.
-    // To keep it simple and correct, we call rebuild.
-    rebuild(rbb);
+void ThreatBoard::incrementalUpdate(const Board& board, int x, int y,
+                                    bool recordUndo) {
+    if (recordUndo) {
+        frames.push_back(ThreatUndoFrame{Move(x, y),
+                                         static_cast<uint32_t>(deltas.size())});
+    }
+    const ThreatCell* flat = &cells[0][0][0][0];
+    for (int d = 0; d < 4; ++d) {
+        const int lineId = Board::lineIdOf(d, x, y);
+        const int offset = Board::lineOffsetOf(d, x, y);
+        const int lo = std::max(0, offset - kRadius);
+        const int hi = std::min(Board::lineLength(d, lineId) - 1, offset + kRadius);
+        for (int p = 0; p < 2; ++p) {
+            if (recordUndo) {
+                for (int o = lo; o <= hi; ++o) {
+                    Move c = Board::lineCell(d, lineId, o);
+                    const ThreatCell& cell = cells[p][c.y][c.x][d];
+                    deltas.push_back(ThreatDelta{
+                        static_cast<uint16_t>(&cell - flat), cell});
+                }
+            }
+            updateLine(board, p, d, lineId, lo, hi);
+        }
+    }
+}
+
+bool ThreatBoard::undoUpdate(const Move& m) {
+    if (frames.empty() || !(frames.back().move == m)) return false;
+    ThreatCell* flat = &cells[0][0][0][0];
+    const uint32_t first = frames.back().firstDelta;
+    for (uint32_t i = static_cast<uint32_t>(deltas.size()); i-- > first; ) {
+        flat[deltas[i].slot] = deltas[i].old;
+    }
+    deltas.resize(first);
+    frames.pop_back();
+    return true;
 }
 
 //------------------------------------------------------------------------------
-// ThreatSolver::PatternTable
+// Locating threats on a line
 //------------------------------------------------------------------------------
 
-void ThreatSolver::PatternTable::initializeOnce() {
-    if (!patterns.empty()) return; // already initialized
+// Sentinel for locateThreat(): classify the move with the pattern table.
+constexpr uint8_t kClassifyMove = 0xFF;
 
-    // Minimal stub: no actual patterns yet.
-    patterns.clear();
-    candidatePatternIds.clear();
-    bestPatternAtCell.clear();
-}
+// A threat created by one move, placed on its line: bit i of the pattern
+// window sits at line offset origin + i.
+struct LineThreat {
+    uint8_t patternId = PatternTable::kNoPattern;
+    int8_t  dir    = 0;
+    int8_t  lineId = 0;
+    int8_t  origin = 0;
+};
 
-const ThreatSolver::PatternTable& ThreatSolver::PatternTable::instance() {
-    static PatternTable table;
-    static std::once_flag once;
-    std::call_once(once, [&]() {
-        table.initializeOnce();
-    });
-    return table;
+inline const ThreatPattern& patternOf(const LineThreat& t) {
+    return PatternTable::instance().pattern(t.patternId);
 }
 
-//------------------------------------------------------------------------------
-// ThreatSolver::SearchContext
-//------------------------------------------------------------------------------
+// Locate the threat 'attacker' creates in direction 'dir' by playing the
+// empty cell 'move'.  With patternId == kClassifyMove the pattern is looked
+// up first.  Returns false if the move creates no threat in that direction.
+bool locateThreat(const Board& board, Player attacker, const Move& move,
+                  int dir, uint8_t patternId, LineThreat& out) {
+    const PatternTable& table = PatternTable::instance();
+    const int lineId = Board::lineIdOf(dir, move.x, move.y);
+    const int offset = Board::lineOffsetOf(dir, move.x, move.y);
+    const int len    = Board::lineLength(dir, lineId);
+    const uint32_t own = board.getLine(attacker, dir, lineId);
+    const uint32_t opp = board.getLine(otherPlayer(attacker), dir, lineId);
 
-struct ThreatSolver::SearchContext {
-    Board boardCopy;
-    Player attacker;
-    ThreatSearchLimits limits;
-    int nodes = 0;
+    int start = offset;
+    while (start > 0 && !((opp >> (start - 1)) & 1U)) --start;
+    int end = offset + 1;
+    while (end < len && !((opp >> end) & 1U)) ++end;
+    const int sub = end - start;
+    if (sub < PatternTable::kMinSubLine) return false;
+    const uint32_t before = (own >> start) & ((1U << sub) - 1U);
 
-    SearchContext(const Board& root, Player a, const ThreatSearchLimits& lim)
-        : boardCopy(root), attacker(a), limits(lim) {}
-};
+    if (patternId == kClassifyMove) {
+        patternId = table.bestPatternAtCell(sub, before, offset - start);
+    }
+    if (patternId == PatternTable::kNoPattern) return false;
 
-//------------------------------------------------------------------------------
-// ThreatSolver: construction / sync
-//------------------------------------------------------------------------------
+    const uint32_t after = before | (1U << (offset - start));
+    int anchor = table.findAnchor(sub, after, patternId, offset - start);
+    if (anchor < 0) return false;
 
-ThreatSolver::ThreatSolver(const Board& board) {
-    PatternTable::instance(); // ensure pattern tables constructed (even if stub)
-    syncFromBoard(board);
+    out.patternId = patternId;
+    out.dir       = static_cast<int8_t>(dir);
+    out.lineId    = static_cast<int8_t>(lineId);
+    out.origin    = static_cast<int8_t>(start + anchor);
+    return true;
 }
 
-void ThreatSolver::syncFromBoard(const Board& board) {
-    rootBoard_ = &board;
-    rebuildRotatedBitboards(board);
-    rebuildThreatBoard();
+// Call fn(Move) for every cell of t whose bit is set in the window mask.
+template <typename Fn>
+void forEachThreatCell(const LineThreat& t, uint16_t mask, Fn fn) {
+    for (int i = 0; mask >> i; ++i) {
+        if ((mask >> i) & 1U) fn(Board::lineCell(t.dir, t.lineId, t.origin + i));
+    }
 }
 
-void ThreatSolver::onRootMoveMade(const Move& m) {
-    if (!rootBoard_) return;
+// True if 'm' is one of the threat's stones.
+bool threatUsesStone(const LineThreat& t, const Move& m) {
+    if (Board::lineIdOf(t.dir, m.x, m.y) != t.lineId) return false;
+    int i = Board::lineOffsetOf(t.dir, m.x, m.y) - t.origin;
+    return i >= 0 && ((patternOf(t).stonesMask >> i) & 1U);
+}
 
-    // After Board::makeMove, sideToMove() is the *next* player.
-    // The stone that was just placed belongs to the opposite side.
-    Player last = otherPlayer(rootBoard_->sideToMove());
-    rotated_.setStone(last, m.x, m.y);
-    threats_.incrementalUpdate(rotated_, m.x, m.y);
+// Expand a located threat into absolute board coordinates.
+void expandThreat(const LineThreat& t, Player attacker, const Move& gain,
+                  ThreatInstance& out) {
+    const ThreatPattern& pat = patternOf(t);
+    out = ThreatInstance{};
+    out.type       = pat.type;
+    out.attacker   = attacker;
+    out.direction  = static_cast<Direction>(t.dir);
+    out.gainSquare = gain;
+    forEachThreatCell(t, pat.stonesMask,    [&](const Move& c) { out.stones.push_back(c); });
+    forEachThreatCell(t, pat.emptyMask,     [&](const Move& c) { out.requiredEmpty.push_back(c); });
+    forEachThreatCell(t, pat.defenseMask,   [&](const Move& c) { out.defensePoints.push_back(c); });
+    forEachThreatCell(t, pat.finishingMask, [&](const Move& c) { out.finishingMoves.push_back(c); });
 }
 
-void ThreatSolver::onRootMoveUndone(const Move& m) {
-    if (!rootBoard_) return;
+// Expand the threat 'patternId' that 'attacker' creates by playing 'move' in
+// direction 'dir' into absolute board coordinates.
+bool buildThreatInstance(const Board& board, Player attacker, const Move& move,
+                         int dir, uint8_t patternId, ThreatInstance& out) {
+    LineThreat t;
+    if (!locateThreat(board, attacker, move, dir, patternId, t)) return false;
+    expandThreat(t, attacker, move, out);
+    return true;
+}
 
-    // After Board::unmakeMove, sideToMove() is the player whose stone was
-    // just removed. So we clear that stone for sideToMove().
-    Player p = rootBoard_->sideToMove();
-    rotated_.clearStone(p, m.x, m.y);
-    threats_.incrementalUpdate(rotated_, m.x, m.y);
+// Strongest threat already standing on the board for 'player' (patterns made
+// of existing stones, e.g. a four waiting to be completed).  The scan stops
+// early once a threat at least as strong as 'stopAt' is seen.
+ThreatType strongestStandingThreat(const Board& board, Player player,
+                                   ThreatType stopAt) {
+    const PatternTable& table = PatternTable::instance();
+    const Player opponent = otherPlayer(player);
+    ThreatType best = ThreatType::None;
+    for (int d = 0; d < 4; ++d) {
+        for (int line = 0; line < Board::lineCount(d); ++line) {
+            const int len = Board::lineLength(d, line);
+            if (len < PatternTable::kMinSubLine) continue;
+            const uint32_t own = board.getLine(player, d, line);
+            if (own == 0U) continue;
+            const uint32_t opp = board.getLine(opponent, d, line);
+            int start = 0;
+            while (start < len) {
+                if ((opp >> start) & 1U) { ++start; continue; }
+                int end = start;
+                while (end < len && !((opp >> end) & 1U)) ++end;
+                const int sub = end - start;
+                const uint32_t stones = (own >> start) & ((1U << sub) - 1U);
+                if (sub >= PatternTable::kMinSubLine && stones != 0U) {
+                    int n = 0;
+                    const PatternRef* refs = table.candidatePatterns(sub, stones, n);
+                    if (n > 0) {
+                        ThreatType t = table.pattern(refs[0].patternId).type;
+                        if (isStrongerThreat(t, best)) best = t;
+                        if (best != ThreatType::None && best <= stopAt) return best;
+                    }
+                }
+                start = end;
+            }
+        }
+    }
+    return best;
 }
 
 //------------------------------------------------------------------------------
-// Internal: rebuild from Board
+// Dependency-based threat-space search (Allis db-search)
 //------------------------------------------------------------------------------
+//
+// The defender is assumed to answer every threat with *all* of its defense
+// points at once (the "all-defenses" trick), which turns the search into a
+// single-player search over attacker threats:
+//
+//   - Dependency stage: starting from the root threats, a child threat must
+//     use the parent's gain square as one of its stones.
+//   - Combination stage: two threat nodes from different branches whose
+//     gain squares share a line (within distance 4) and whose squares do not
+//     conflict are merged into a combination node; its children must use
+//     both gain squares.
+//
+// Stages alternate until a goal is reached, nothing new appears, or the
+// limits run out.  Goals are a Five, or an OpenFour while the defender cannot
+// complete a five.
+//
+// Soundness guards against defender counter-play:
+//   - A three is only played if the defender then has no move that makes a
+//     four (it could answer with tempo instead of defending).
+//   - A four is only played if the defender cannot complete a five.
+//   - If the defense stones give the defender a four, only an immediate Five
+//     is accepted from that node.
+//
+// Nodes live in a per-solver arena (ThreatSearchScratch) that is cleared but
+// not freed between calls.  The search reads positions from one working
+// Board: moving to a node places and removes only the stones in which its
+// path differs from the node before, so a node costs its stone delta
+// rather than a Board copy.
 
-void ThreatSolver::rebuildRotatedBitboards(const Board& board) {
-    std::memset(rotated_.bb, 0, sizeof(rotated_.bb));
+// 144-bit cell set with the same layout as Board's bitboards.
+struct CellSet {
+    uint64_t w[3] = {0ULL, 0ULL, 0ULL};
 
-    for (int y = 0; y < GOMOKU_BOARD_SIZE; ++y) {
-        for (int x = 0; x < GOMOKU_BOARD_SIZE; ++x) {
-            int state = board.getCellState(x, y);
-            if (state == 1) {
-                rotated_.setStone(Player::Black, x, y);
-            } else if (state == 2) {
-                rotated_.setStone(Player::White, x, y);
+    void set(const Move& m) {
+        int idx = boardIndex(m.x, m.y);
+        w[idx >> 6] |= 1ULL << (idx & 63);
+    }
+    bool test(const Move& m) const {
+        int idx = boardIndex(m.x, m.y);
+        return (w[idx >> 6] >> (idx & 63)) & 1ULL;
+    }
+    bool intersects(const CellSet& o) const {
+        return ((w[0] & o.w[0]) | (w[1] & o.w[1]) | (w[2] & o.w[2])) != 0ULL;
+    }
+    bool subsetOf(const CellSet& o) const {
+        return ((w[0] & ~o.w[0]) | (w[1] & ~o.w[1]) | (w[2] & ~o.w[2])) == 0ULL;
+    }
+    int count() const {
+        return popcount64(w[0]) + popcount64(w[1]) + popcount64(w[2]);
+    }
+    CellSet operator|(const CellSet& o) const {
+        CellSet r;
+        for (int i = 0; i < 3; ++i) r.w[i] = w[i] | o.w[i];
+        return r;
+    }
+    CellSet minus(const CellSet& o) const {
+        CellSet r;
+        for (int i = 0; i < 3; ++i) r.w[i] = w[i] & ~o.w[i];
+        return r;
+    }
+    template <typename Fn>
+    void forEach(Fn fn) const {
+        forEachSetBit(w, [&fn](int idx) {
+            fn(Move(idx % GOMOKU_BOARD_SIZE, idx / GOMOKU_BOARD_SIZE));
+        });
+    }
+};
+
+inline uint64_t mix64(uint64_t z) {
+    z += 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+inline uint64_t hashState(const CellSet& att, const CellSet& def) {
+    uint64_t h = 0ULL;
+    for (int i = 0; i < 3; ++i) {
+        h = mix64(h ^ att.w[i]);
+        h = mix64(h ^ (def.w[i] * 0xD6E8FEB86659FD93ULL));
+    }
+    return h;
+}
+
+struct ThreatNode {
+    int32_t    parent  = -1;       // threat this one depends on (-1 = root)
+    int32_t    parent2 = -1;       // second component of a combination node
+    int32_t    nextSameGain = -1;  // bucket chain for the combination stage
+    LineThreat threat;             // patternId == kNoPattern for combinations
+    Move       gain;               // gain square (threat nodes)
+    Move       keys[2];            // squares every child threat must use
+    uint8_t    keyCount = 0;
+    uint8_t    depth = 0;          // number of threats on the longest path
+    int8_t     comboDir = -1;      // line shared by both keys (combinations)
+    bool       onlyFives = false;  // defender threatens five here
+    CellSet    attackerStones;     // gain squares on the path(s)
+    CellSet    defenderStones;     // cost squares on the path(s)
+    CellSet    windows;            // squares covered by the path's threats
+};
+
+struct ThreatSearchScratch {
+    static constexpr int kDedupBits = 16;
+
+    // Working position of the db-searches: the root between searches.
+    Board position;
+
+    std::vector<ThreatNode> nodes;
+    int32_t                 gainHead[GOMOKU_BOARD_SIZE * GOMOKU_BOARD_SIZE];
+
+    // Sequence extraction buffers (kept to avoid reallocating).
+    std::vector<uint8_t> marks;
+    std::vector<int32_t> stack;
+
+    // Open-addressing set of visited (attacker, defender) stone sets.  Stamps
+    // avoid clearing the table between calls.
+    std::vector<uint64_t> dedupKeys;
+    std::vector<uint32_t> dedupStamps;
+    uint32_t              stamp = 0;
+
+    void reset() {
+        nodes.clear();
+        std::fill(gainHead, gainHead + GOMOKU_BOARD_SIZE * GOMOKU_BOARD_SIZE, -1);
+        if (dedupKeys.empty()) {
+            dedupKeys.assign(std::size_t(1) << kDedupBits, 0ULL);
+            dedupStamps.assign(std::size_t(1) << kDedupBits, 0U);
+        }
+        if (++stamp == 0U) {
+            std::fill(dedupStamps.begin(), dedupStamps.end(), 0U);
+            stamp = 1U;
+        }
+    }
+
+    // Returns false if 'key' was already inserted during this call.  When
+    // the probe window is full the key is accepted without being recorded.
+    bool insertState(uint64_t key) {
+        const std::size_t mask = dedupKeys.size() - 1;
+        std::size_t slot = static_cast<std::size_t>(key) & mask;
+        for (int probe = 0; probe < 8; ++probe, slot = (slot + 1) & mask) {
+            if (dedupStamps[slot] != stamp) {
+                dedupStamps[slot] = stamp;
+                dedupKeys[slot] = key;
+                return true;
             }
+            if (dedupKeys[slot] == key) return false;
         }
+        return true;
     }
+};
+
+enum class SearchOutcome {
+    Win,     // a winning threat sequence was found
+    NoWin,   // the search space was exhausted without a win
+    Unknown  // stopped by maxNodes or abortFlag
+};
+
+// One db-search from the position in 'state', which it changes while it
+// runs and hands back unchanged.
+class DbSearch {
+public:
+    DbSearch(Board& state, Player attacker, const ThreatSearchLimits& limits,
+             ThreatSearchScratch& scratch, int& nodeCounter)
+        : state_(state), attacker_(attacker), defender_(otherPlayer(attacker)),
+          limits_(limits), scratch_(scratch), nodes_(nodeCounter) {}
+
+    SearchOutcome run(ThreatSequence* outSeq);
+
+private:
+    bool outOfBudget();
+    // Bring state_ to the root plus the given path stones.
+    void moveTo(const CellSet& attackerStones, const CellSet& defenderStones);
+    void expandRoot();
+    void expandNode(int index);
+    void tryChild(int parent, const Move& c, const LineThreat& t);
+    void combineStage(int first, int last);
+    void tryCombine(int a, int b, int dir);
+    void extractSequence(ThreatSequence& out) const;
+
+    Board&                    state_;
+    CellSet                   placed_[2];  // path stones on state_: attacker, defender
+    Player                    attacker_;
+    Player                    defender_;
+    const ThreatSearchLimits& limits_;
+    ThreatSearchScratch&      scratch_;
+    int&                      nodes_;
+
+    bool       aborted_ = false;
+    bool       won_ = false;
+    int        goalParent_ = -1;   // node the winning threat is played from
+    LineThreat goalThreat_;
+    Move       goalMove_;
+};
+
+bool DbSearch::outOfBudget() {
+    if (aborted_) return true;
+    if (++nodes_ > limits_.maxNodes ||
+        (limits_.abortFlag && limits_.abortFlag->load(std::memory_order_relaxed)) ||
+        (limits_.extraAbortFlag && limits_.extraAbortFlag->load(std::memory_order_relaxed))) {
+        aborted_ = true;
+    }
+    return aborted_;
 }
 
-void ThreatSolver::rebuildThreatBoard() {
-    threats_.rebuild(rotated_);
+void DbSearch::moveTo(const CellSet& attackerStones, const CellSet& defenderStones) {
+    // Removals first: a cell can change from one side's path to the other's.
+    placed_[0].minus(attackerStones).forEach(
+        [&](const Move& m) { state_.removeStone(m.x, m.y, attacker_); });
+    placed_[1].minus(defenderStones).forEach(
+        [&](const Move& m) { state_.removeStone(m.x, m.y, defender_); });
+    attackerStones.minus(placed_[0]).forEach(
+        [&](const Move& m) { state_.placeStone(m.x, m.y, attacker_); });
+    defenderStones.minus(placed_[1]).forEach(
+        [&](const Move& m) { state_.placeStone(m.x, m.y, defender_); });
+    placed_[0] = attackerStones;
+    placed_[1] = defenderStones;
 }
 
-//------------------------------------------------------------------------------
-// Minimal immediate winning move detection
-//------------------------------------------------------------------------------
+void DbSearch::tryChild(int parent, const Move& c, const LineThreat& t) {
+    if (outOfBudget()) return;
 
-static bool isImmediateWinningMove(Board& board,
-                                   const Move& m,
-                                   Player attacker) {
-    // Assumes m is empty on board.
-    if (!board.makeMove(m.x, m.y)) {
-        return false;
+    const ThreatPattern& pat = patternOf(t);
+    if (pat.type == ThreatType::Five) {
+        won_ = true;
+        goalParent_ = parent;
+        goalThreat_ = t;
+        goalMove_   = c;
+        return;
     }
-    bool win = board.checkWin(attacker);
-    board.unmakeMove(m.x, m.y);
-    return win;
+
+    const ThreatNode* p = (parent >= 0) ? &scratch_.nodes[parent] : nullptr;
+    const int depth = (p ? p->depth : 0) + 1;
+    if (depth > limits_.maxDepth) return;
+
+    const bool isThree = (pat.type == ThreatType::OpenThree ||
+                          pat.type == ThreatType::BrokenThree);
+    state_.placeStone(c.x, c.y, attacker_);
+
+    // Counter-play guard: a three lets the defender reply with any four,
+    // a four only loses to a defender five.
+    ThreatType counter = strongestStandingThreat(
+        state_, defender_, isThree ? ThreatType::SimpleThree : ThreatType::SimpleFour);
+    bool ok = isThree ? !(counter != ThreatType::None && counter <= ThreatType::SimpleThree)
+                      : !(counter != ThreatType::None && counter <= ThreatType::SimpleFour);
+
+    // An open four wins unless the defender completes a five first ('ok').
+    // Fours of its own do not help: the attacker answers the first one by
+    // taking whichever five square is still free.
+    if (ok && pat.type == ThreatType::OpenFour) {
+        state_.removeStone(c.x, c.y, attacker_);
+        won_ = true;
+        goalParent_ = parent;
+        goalThreat_ = t;
+        goalMove_   = c;
+        return;
+    }
+
+    if (ok) {
+        ThreatNode n;
+        n.parent   = parent;
+        n.threat   = t;
+        n.gain     = c;
+        n.keys[0]  = c;
+        n.keyCount = 1;
+        n.depth    = static_cast<uint8_t>(depth);
+        if (p) {
+            n.attackerStones = p->attackerStones;
+            n.defenderStones = p->defenderStones;
+            n.windows        = p->windows;
+        }
+        n.attackerStones.set(c);
+        forEachThreatCell(t, pat.defenseMask, [&](const Move& d) {
+            n.defenderStones.set(d);
+            state_.placeStone(d.x, d.y, defender_);
+        });
+        forEachThreatCell(t, static_cast<uint16_t>(pat.stonesMask | pat.emptyMask),
+                          [&](const Move& w) { n.windows.set(w); });
+
+        ThreatType after = strongestStandingThreat(state_, defender_, ThreatType::SimpleFour);
+        if (after == ThreatType::Five) {
+            ok = false;
+        } else {
+            n.onlyFives = (after != ThreatType::None && after <= ThreatType::SimpleFour);
+        }
+        // Leave room for the goal move in a ThreatSequence.
+        if (n.attackerStones.count() >= static_cast<int>(kMaxThreatSequenceMoves)) ok = false;
+        if (ok && scratch_.insertState(hashState(n.attackerStones, n.defenderStones))) {
+            const int index = static_cast<int>(scratch_.nodes.size());
+            const int cell  = boardIndex(c.x, c.y);
+            n.nextSameGain = scratch_.gainHead[cell];
+            scratch_.gainHead[cell] = index;
+            scratch_.nodes.push_back(n);
+        }
+        forEachThreatCell(t, pat.defenseMask, [&](const Move& d) {
+            state_.removeStone(d.x, d.y, defender_);
+        });
+    }
+    state_.removeStone(c.x, c.y, attacker_);
 }
 
-//------------------------------------------------------------------------------
-// ThreatSolver: public queries
-//------------------------------------------------------------------------------
+void DbSearch::expandRoot() {
+    const bool onlyFives = [&]() {
+        ThreatType t = strongestStandingThreat(state_, defender_, ThreatType::SimpleFour);
+        return t != ThreatType::None && t <= ThreatType::SimpleFour;
+    }();
+    // tryChild() places and removes stones; the range iterates its own copy.
+    for (const Move& m : state_.emptyCells()) {
+        if (won_ || aborted_) break;
+        for (int d = 0; d < 4 && !won_ && !aborted_; ++d) {
+            LineThreat t;
+            if (!locateThreat(state_, attacker_, m, d, kClassifyMove, t)) continue;
+            ThreatType type = patternOf(t).type;
+            if (!isForcingOrWinning(type)) continue;
+            if (onlyFives && type != ThreatType::Five) continue;
+            tryChild(-1, m, t);
+        }
+    }
+}
 
-bool ThreatSolver::findWinningThreatSequence(Player attacker,
-                                             ThreatSequence& outSequence,
-                                             const ThreatSearchLimits& limits) const {
-    return runWinningThreatSearch(attacker, outSequence, limits);
+void DbSearch::expandNode(int index) {
+    const ThreatNode node = scratch_.nodes[index]; // copy: arena may grow
+    moveTo(node.attackerStones, node.defenderStones);
+    const Move key = node.keys[0];
+    for (int d = 0; d < 4 && !won_ && !aborted_; ++d) {
+        if (node.keyCount == 2 && d != node.comboDir) continue;
+        const int lineId = Board::lineIdOf(d, key.x, key.y);
+        const int offset = Board::lineOffsetOf(d, key.x, key.y);
+        const int lo = std::max(0, offset - (GOMOKU_WIN_LENGTH - 1));
+        const int hi = std::min(Board::lineLength(d, lineId) - 1,
+                                offset + (GOMOKU_WIN_LENGTH - 1));
+        for (int o = lo; o <= hi && !won_ && !aborted_; ++o) {
+            const Move c = Board::lineCell(d, lineId, o);
+            if (state_.isOccupied(c.x, c.y)) continue;
+            LineThreat t;
+            if (!locateThreat(state_, attacker_, c, d, kClassifyMove, t)) continue;
+            ThreatType type = patternOf(t).type;
+            if (!isForcingOrWinning(type)) continue;
+            if (node.onlyFives && type != ThreatType::Five) continue;
+            bool dependent = true;
+            for (int k = 0; k < node.keyCount; ++k) {
+                dependent = dependent && threatUsesStone(t, node.keys[k]);
+            }
+            if (!dependent) continue;
+            tryChild(index, c, t);
+        }
+    }
 }
 
-DefensiveSet ThreatSolver::computeDefensiveSet(Player defender,
-                                               const ThreatSearchLimits& limits) const {
-    return runDefensiveSetSearch(defender, limits);
+void DbSearch::tryCombine(int a, int b, int dir) {
+    const ThreatNode& A = scratch_.nodes[a];
+    const ThreatNode& B = scratch_.nodes[b];
+    // Squares one branch plays must not sit in the other's threats.
+    if (A.attackerStones.intersects(B.defenderStones) ||
+        A.defenderStones.intersects(B.attackerStones)) return;
+    if (A.attackerStones.subsetOf(B.attackerStones) ||
+        B.attackerStones.subsetOf(A.attackerStones)) return;
+    const CellSet aOwn = (A.attackerStones | A.defenderStones)
+                             .minus(B.attackerStones | B.defenderStones);
+    const CellSet bOwn = (B.attackerStones | B.defenderStones)
+                             .minus(A.attackerStones | A.defenderStones);
+    if (aOwn.intersects(B.windows.minus(A.windows)) ||
+        bOwn.intersects(A.windows.minus(B.windows))) return;
+
+    ThreatNode n;
+    n.parent         = a;
+    n.parent2        = b;
+    n.keys[0]        = A.gain;
+    n.keys[1]        = B.gain;
+    n.keyCount       = 2;
+    n.comboDir       = static_cast<int8_t>(dir);
+    n.depth          = std::max(A.depth, B.depth);
+    n.attackerStones = A.attackerStones | B.attackerStones;
+    n.defenderStones = A.defenderStones | B.defenderStones;
+    n.windows        = A.windows | B.windows;
+    if (n.attackerStones.count() >= static_cast<int>(kMaxThreatSequenceMoves)) return;
+    if (!scratch_.insertState(hashState(n.attackerStones, n.defenderStones))) return;
+    if (outOfBudget()) return;
+
+    moveTo(n.attackerStones, n.defenderStones);
+    ThreatType after = strongestStandingThreat(state_, defender_, ThreatType::SimpleFour);
+    if (after == ThreatType::Five) return;
+    n.onlyFives = (after != ThreatType::None && after <= ThreatType::SimpleFour);
+    scratch_.nodes.push_back(n);
 }
 
-bool ThreatSolver::hasImmediateWinningThreat(Player player) const {
-    if (!rootBoard_) return false;
+void DbSearch::combineStage(int first, int last) {
+    for (int i = first; i < last && !aborted_; ++i) {
+        if (scratch_.nodes[i].keyCount != 1) continue;
+        const Move g = scratch_.nodes[i].gain;
+        for (int d = 0; d < 4 && !aborted_; ++d) {
+            const int lineId = Board::lineIdOf(d, g.x, g.y);
+            const int offset = Board::lineOffsetOf(d, g.x, g.y);
+            const int lo = std::max(0, offset - (GOMOKU_WIN_LENGTH - 1));
+            const int hi = std::min(Board::lineLength(d, lineId) - 1,
+                                    offset + (GOMOKU_WIN_LENGTH - 1));
+            for (int o = lo; o <= hi && !aborted_; ++o) {
+                if (o == offset) continue;
+                const Move q = Board::lineCell(d, lineId, o);
+                for (int j = scratch_.gainHead[boardIndex(q.x, q.y)];
+                     j >= 0 && !aborted_; j = scratch_.nodes[j].nextSameGain) {
+                    // Pair each new node with older ones once.
+                    if (j >= i && j >= first) continue;
+                    tryCombine(i, j, d);
+                }
+            }
+        }
+    }
+}
 
-    // 1) Already-winning position (five on board).
-    if (rootBoard_->checkWin(player)) {
-        return true;
+SearchOutcome DbSearch::run(ThreatSequence* outSeq) {
+    if (state_.checkWin(attacker_)) {
+        // We don't attempt to reconstruct the exact five; at the engine level,
+        // knowing "there is a winning threat right now" is enough.
+        if (outSeq) {
+            *outSeq = ThreatSequence{};
+            outSeq->attacker = attacker_;
+        }
+        return SearchOutcome::Win;
     }
+    if (state_.checkWin(defender_)) return SearchOutcome::NoWin;
+
+    scratch_.reset();
+    expandRoot();
 
-    // 2) Any immediate winning move?
-    Board tmp = *rootBoard_;
-    auto legal = tmp.getLegalMoves();
-    for (const auto& m : legal) {
-        if (isImmediateWinningMove(tmp, m, player)) {
-            return true;
+    int expandFrom = 0;
+    while (!won_ && !aborted_) {
+        // Dependency stage: expand everything added since the last stage,
+        // including nodes created along the way (breadth-first).
+        const int stageStart = expandFrom;
+        for (int i = expandFrom; i < static_cast<int>(scratch_.nodes.size()) &&
+                                 !won_ && !aborted_; ++i) {
+            expandNode(i);
         }
+        if (won_ || aborted_) break;
+
+        // Combination stage over the threat nodes created in this stage.
+        const int stageEnd = static_cast<int>(scratch_.nodes.size());
+        combineStage(stageStart, stageEnd);
+        if (static_cast<int>(scratch_.nodes.size()) == stageEnd) break;
+        expandFrom = stageEnd;
     }
-    return false;
+
+    moveTo(CellSet(), CellSet());
+    if (won_) {
+        if (outSeq) extractSequence(*outSeq);
+        return SearchOutcome::Win;
+    }
+    return aborted_ ? SearchOutcome::Unknown : SearchOutcome::NoWin;
 }
 
-void ThreatSolver::collectCurrentForcingThreats(Player player,
-                                                std::vector<ThreatInstance>& out) const {
-    if (!rootBoard_) return;
-
-    Board tmp = *rootBoard_;
-    auto legal = tmp.getLegalMoves();
-    for (const auto& m : legal) {
-        if (isImmediateWinningMove(tmp, m, player)) {
-            ThreatInstance t;
-            t.type  = ThreatType::Five;
-            t.owner = player;
-            t.stonesCount = 0;
-            t.requiredEmptyCount = 0;
-            t.defenseCount = 0;
-            t.finishingCount = 1;
-            t.finishing[0] = m;
-            out.push_back(t);
-        }
+void DbSearch::extractSequence(ThreatSequence& out) const {
+    out.attacker = attacker_;
+    out.threats.clear();
+    out.attackerMoves.clear();
+    out.defenderMoves.clear();
+
+    // Mark every node the goal depends on; parents always have smaller
+    // indices, so ascending order is a valid play order.
+    std::vector<uint8_t>& onPath = scratch_.marks;
+    std::vector<int32_t>& stack  = scratch_.stack;
+    onPath.assign(scratch_.nodes.size(), 0);
+    stack.clear();
+    if (goalParent_ >= 0) stack.push_back(goalParent_);
+    while (!stack.empty()) {
+        int i = stack.back();
+        stack.pop_back();
+        if (onPath[i]) continue;
+        onPath[i] = 1;
+        const ThreatNode& n = scratch_.nodes[i];
+        if (n.parent  >= 0) stack.push_back(n.parent);
+        if (n.parent2 >= 0) stack.push_back(n.parent2);
     }
+
+    CellSet played;
+    for (int i = 0; i <= goalParent_; ++i) {
+        if (!onPath[i]) continue;
+        const ThreatNode& n = scratch_.nodes[i];
+        if (n.keyCount != 1) continue; // combination nodes add no moves
+        if (played.test(n.gain)) continue;
+        played.set(n.gain);
+        out.threats.push_back(ThreatInstance{});
+        expandThreat(n.threat, attacker_, n.gain, out.threats.back());
+        out.attackerMoves.push_back(n.gain);
+        const auto& defenses = out.threats.back().defensePoints;
+        out.defenderMoves.insert(out.defenderMoves.end(), defenses.begin(), defenses.end());
+    }
+    out.threats.push_back(ThreatInstance{});
+    expandThreat(goalThreat_, attacker_, goalMove_, out.threats.back());
+    out.attackerMoves.push_back(goalMove_);
 }
 
 //------------------------------------------------------------------------------
-// Internal: simplified winning threat search
+// Winning threat search / defensive set search
 //------------------------------------------------------------------------------
+
+// Copies 'rootBoard' into scratch.position, where it stays for a following
+// defensesAgainst().  'nodes' counts the search's node expansions (against
+// limits.maxNodes).
+SearchOutcome runWinningThreatSearch(const Board* rootBoard,
+                                     Player attacker,
+                                     ThreatSequence& outSeq,
+                                     const ThreatSearchLimits& limits,
+                                     ThreatSearchScratch& scratch,
+                                     int& nodes) {
+    if (!rootBoard) return SearchOutcome::NoWin;
+    scratch.position = *rootBoard;
+    DbSearch search(scratch.position, attacker, limits, scratch, nodes);
+    return search.run(&outSeq);
+}
+
+// Best threat 'player' would create by playing the empty cell 'm' (any
+// direction), without locating the pattern.
+ThreatType bestThreatForMove(const Board& board, Player player, const Move& m) {
+    ThreatType best = ThreatType::None;
+    for (int d = 0; d < 4; ++d) {
+        LineThreat t;
+        if (locateThreat(board, player, m, d, kClassifyMove, t)) {
+            ThreatType type = patternOf(t).type;
+            if (isStrongerThreat(type, best)) best = type;
+        }
+    }
+    return best;
+}
+
 //
-// We implement a minimal "one-ply" threat search:
+// Defenses follow "defenses to potential threat sequences": find one winning
+// sequence for the attacker, then try each square that could break it (its
+// gain, cost and required-empty squares) plus every defender move that
+// makes a forcing threat of its own (tempo).  A candidate is a defense if
+// the attacker has no winning sequence after it.
 //
-//   - If attacker already has five in a row: treat as winning.
-//   - Else, if attacker has a move that makes a five: treat that as a winning
-//     sequence of length 1.
+//   - No sequence found:    isLost = false, defensiveMoves = {} (search all).
+//   - Some candidates hold: isLost = false, defensiveMoves = those moves.
+//   - None hold:            isLost = true.
 //
-// This is intentionally simple but correct for immediate tactical wins.
-// It can be replaced later with a full dependency-based threat sequence search.
+// Running out of nodes or being aborted at any point yields "no
+// information" (isLost = false, defensiveMoves = {}).
 //
 
-bool ThreatSolver::runWinningThreatSearch(Player attacker,
-                                          ThreatSequence& outSeq,
-                                          const ThreatSearchLimits& limits) const {
-    if (!rootBoard_) return false;
+// If the defender can complete a five, the attacker's threats are moot.
+bool defenderHasFour(const Board& board, Player defender) {
+    ThreatType own = strongestStandingThreat(board, defender, ThreatType::SimpleFour);
+    return own != ThreatType::None && own <= ThreatType::SimpleFour;
+}
 
-    SearchContext ctx(*rootBoard_, attacker, limits);
+// The candidate stage, given the attacker's winning sequence 'seq' from the
+// root in scratch.position and the 'nodes' already spent finding it.  Each
+// candidate is tried on scratch.position itself.
+DefensiveSet defensesAgainst(Player defender,
+                             const ThreatSequence& seq,
+                             const ThreatSearchLimits& limits,
+                             ThreatSearchScratch& scratch,
+                             int& nodes) {
+    DefensiveSet result;
+    const Player attacker = otherPlayer(defender);
+    Board& position = scratch.position;
 
-    // 1) Already winning position.
-    if (ctx.boardCopy.checkWin(attacker)) {
-        ThreatSequence seq;
-        // We don't attempt to reconstruct the exact five; at the engine level,
-        // knowing "there is a winning threat right now" is enough.
-        outSeq = std::move(seq);
-        return true;
+    CellSet candidates;
+    for (const auto& t : seq.threats) {
+        candidates.set(t.gainSquare);
+        for (const auto& m : t.requiredEmpty) candidates.set(m);
+    }
+    for (const auto& m : seq.defenderMoves) candidates.set(m);
+    for (const Move& m : position.emptyCells()) {
+        if (isForcingOrWinning(bestThreatForMove(position, defender, m))) candidates.set(m);
     }
 
-    // 2) Any immediate winning move?
-    auto legal = ctx.boardCopy.getLegalMoves();
-    for (const auto& m : legal) {
-        if (ctx.limits.abortFlag && *ctx.limits.abortFlag) {
-            return false; // aborted, no information
-        }
-        if (++ctx.nodes > ctx.limits.maxNodes) {
-            return false; // hit node limit, no information
+    bool unknown = false;
+    candidates.forEach([&](const Move& m) {
+        if (unknown || position.isOccupied(m.x, m.y)) return;
+        position.placeStone(m.x, m.y, defender);
+        DbSearch search(position, attacker, limits, scratch, nodes);
+        SearchOutcome outcome = search.run(nullptr);
+        position.removeStone(m.x, m.y, defender);
+        if (outcome == SearchOutcome::Unknown) {
+            unknown = true;
+        } else if (outcome == SearchOutcome::NoWin) {
+            result.defensiveMoves.push_back(m);
         }
+    });
+    if (unknown) return DefensiveSet{};
 
-        if (isImmediateWinningMove(ctx.boardCopy, m, attacker)) {
-            ThreatSequence seq;
-            ThreatInstance t;
-            t.type  = ThreatType::Five;
-            t.owner = attacker;
-            t.finishing[0] = m;
-            t.finishingCount = 1;
-            seq.threats.push_back(t);
-            seq.attackerMoves.push_back(m);
-            outSeq = std::move(seq);
-            return true;
+    result.isLost = result.defensiveMoves.empty();
+    return result;
+}
+
+DefensiveSet runDefensiveSetSearch(const Board* rootBoard,
+                                   Player defender,
+                                   const ThreatSearchLimits& limits,
+                                   ThreatSearchScratch& scratch) {
+    if (!rootBoard || defenderHasFour(*rootBoard, defender)) return DefensiveSet{};
+    int nodes = 0;
+    ThreatSequence seq;
+    if (runWinningThreatSearch(rootBoard, otherPlayer(defender), seq, limits, scratch, nodes) !=
+        SearchOutcome::Win) {
+        return DefensiveSet{};
+    }
+    return defensesAgainst(defender, seq, limits, scratch, nodes);
+}
+
+} // namespace
+
+//------------------------------------------------------------------------------
+// ThreatSolver::Impl
+//------------------------------------------------------------------------------
+
+struct ThreatSolver::Impl {
+    // We only need a pointer to the current root Board to read stones and
+    // know which side is to move, but we never mutate it.
+    const Board* rootBoard = nullptr;
+    ThreatBoard  threats;
+
+    // Node arena reused by every threat search from this solver.
+    mutable ThreatSearchScratch scratch;
+
+    // analyzeThreats() results; copies of a solver share the same cache.
+    std::shared_ptr<ThreatCache> cache;
+};
+
+//------------------------------------------------------------------------------
+// ThreatSolver: construction / sync
+//------------------------------------------------------------------------------
+
+ThreatSolver::ThreatSolver(const Board& board) : impl_(new Impl) {
+    PatternTable::instance(); // ensure pattern tables constructed
+    impl_->cache = std::make_shared<ThreatCache>();
+    syncFromBoard(board);
+}
+
+ThreatSolver::ThreatSolver(const ThreatSolver& other)
+    : impl_(new Impl(*other.impl_)) {}
+
+ThreatSolver& ThreatSolver::operator=(const ThreatSolver& other) {
+    if (this != &other) {
+        *impl_ = *other.impl_;
+    }
+    return *this;
+}
+
+ThreatSolver::ThreatSolver(ThreatSolver&& other) noexcept = default;
+ThreatSolver& ThreatSolver::operator=(ThreatSolver&& other) noexcept = default;
+ThreatSolver::~ThreatSolver() = default;
+
+void ThreatSolver::syncFromBoard(const Board& board) {
+    impl_->rootBoard = &board;
+    impl_->threats.rebuild(board);
+}
+
+void ThreatSolver::notifyMove(const Move& m) {
+    if (!impl_->rootBoard || !onBoard(m.x, m.y)) return;
+    // Board has already updated its line bitboards in makeMove().
+    impl_->threats.incrementalUpdate(*impl_->rootBoard, m.x, m.y, true);
+}
+
+void ThreatSolver::notifyUndo(const Move& m) {
+    if (!impl_->rootBoard || !onBoard(m.x, m.y)) return;
+    // The normal case pops the cells saved by the matching notifyMove().
+    // Undoing a move that was never notified falls back to re-classifying
+    // the cells around it from the (already unmade) board.
+    if (!impl_->threats.undoUpdate(m)) {
+        impl_->threats.incrementalUpdate(*impl_->rootBoard, m.x, m.y, false);
+    }
+}
+
+bool ThreatSolver::collectForcingMoves(const Board& board, Player attacker,
+                                       ForcingMoves& out) {
+    if (impl_->rootBoard != &board) syncFromBoard(board);
+    out.fives.clear();
+    out.fours.clear();
+    out.threes.clear();
+
+    const int p = playerIndex(attacker);
+    for (const Move& m : board.emptyCells()) {
+        ThreatType best = ThreatType::None;
+        for (int d = 0; d < 4; ++d) {
+            const ThreatType t = impl_->threats.cells[p][m.y][m.x][d].type;
+            if (isStrongerThreat(t, best)) best = t;
+        }
+        if (!isForcingOrWinning(best)) continue;
+        if (best == ThreatType::Five) {
+            out.fives.push_back(m);
+        } else if (best == ThreatType::OpenFour || best == ThreatType::SimpleFour) {
+            out.fours.push_back(m);
+        } else {
+            out.threes.push_back(m);
         }
     }
+    return true;
+}
 
-    return false;
+ThreatType ThreatSolver::getThreatAt(Player attacker,
+                                     const Move& move,
+                                     Direction direction) const {
+    if (!onBoard(move.x, move.y)) return ThreatType::None;
+    return impl_->threats.cells[playerIndex(attacker)][move.y][move.x]
+                               [static_cast<int>(direction)].type;
+}
+
+void ThreatSolver::getThreatsAt(Player attacker,
+                                const Move& move,
+                                std::vector<ThreatType>& out) const {
+    out.assign(4, ThreatType::None);
+    if (!onBoard(move.x, move.y)) return;
+    for (int d = 0; d < 4; ++d) {
+        out[d] = impl_->threats.cells[playerIndex(attacker)][move.y][move.x][d].type;
+    }
 }
 
 //------------------------------------------------------------------------------
-// Internal: simplified defensive set search
+// ThreatSolver: public queries
 //------------------------------------------------------------------------------
-//
-// We look only for *immediate* winning moves from the opponent:
-//
-//   - attacker = otherPlayer(defender)
-//   - Find all moves where attacker can immediately make a five.
-//   - If none:   isLost = false, defensiveMoves = {} (search engine plays all).
-//   - If one:    isLost = false, defensiveMoves = { that move }.
-//   - If >1:     isLost = true (double threat).
-//
 
-DefensiveSet ThreatSolver::runDefensiveSetSearch(Player defender,
-                                                 const ThreatSearchLimits& limits) const {
-    DefensiveSet result;
-    if (!rootBoard_) return result;
+bool ThreatSolver::findWinningThreatSequence(Player attacker,
+                                             ThreatSequence& outSequence,
+                                             const ThreatSearchLimits& limits) const {
+    int nodes = 0;
+    return runWinningThreatSearch(impl_->rootBoard, attacker, outSequence, limits,
+                                  impl_->scratch, nodes) == SearchOutcome::Win;
+}
 
-    Player attacker = otherPlayer(defender);
+DefensiveSet ThreatSolver::computeDefensiveSet(Player defender,
+                                               const ThreatSearchLimits& limits) const {
+    return runDefensiveSetSearch(impl_->rootBoard, defender, limits, impl_->scratch);
+}
 
-    Board tmp = *rootBoard_;
-    auto legal = tmp.getLegalMoves();
+ThreatAnalysis ThreatSolver::analyzeThreats(const Board& board, Player attacker,
+                                            const ThreatSearchLimits& limits) {
+    if (impl_->rootBoard != &board) syncFromBoard(board);
 
-    std::vector<Move> winningMoves;
-    int nodes = 0;
+    ThreatAnalysis result;
+    const uint64_t key = ThreatCache::keyOf(board.getHashKey(), attacker);
+    if (impl_->cache->probe(key, limits.maxNodes, result)) return result;
 
-    for (const auto& m : legal) {
-        if (limits.abortFlag && *limits.abortFlag) {
-            // Abort → return "no information", i.e., not lost, no restricted set.
-            return result;
+    // 1. Check for Forced Win
+    int nodes = 0;
+    ThreatSequence winningSeq;
+    if (runWinningThreatSearch(&board, attacker, winningSeq, limits, impl_->scratch, nodes) ==
+        SearchOutcome::Win) {
+        result.attackerHasForcedWin = true;
+        if (!winningSeq.attackerMoves.empty()) {
+            result.firstWinningMove = winningSeq.attackerMoves.front();
         }
-        if (++nodes > limits.maxNodes) {
-            // Hit node cap → same: no information.
-            return result;
+        result.winningLine = winningSeq.attackerMoves;
+    }
+
+    // 2. Compute Defenses: moves the *defender* could play to stop 'attacker'.
+    // This is computeDefensiveSet() on the sequence just found: without a
+    // win there is nothing to defend, and if the defender loses anyway the
+    // set stays empty.
+    Player defender = otherPlayer(attacker);
+    if (result.attackerHasForcedWin && !defenderHasFour(board, defender)) {
+        DefensiveSet ds = defensesAgainst(defender, winningSeq, limits, impl_->scratch, nodes);
+        if (!ds.isLost) {
+            result.defensiveMoves = ds.defensiveMoves;
         }
+    }
+
+    // An aborted search carries no information; don't let it shadow a
+    // complete result later.
+    if (!(limits.abortFlag && limits.abortFlag->load(std::memory_order_relaxed)) &&
+        !(limits.extraAbortFlag && limits.extraAbortFlag->load(std::memory_order_relaxed))) {
+        impl_->cache->store(key, limits.maxNodes, result);
+    }
+    return result;
+}
+
+ThreatCacheStats ThreatSolver::cacheStats() const {
+    return impl_->cache->stats();
+}
+
+RootProofResult ThreatSolver::proveRootMoves(const Board& board, const MoveList& moves,
+                                             int threads, const ThreatSearchLimits& limits) {
+    RootProofResult result;
+    for (std::size_t i = 0; i < moves.size(); ++i) result.proofs.push_back(RootMoveProof::Unknown);
+    if (moves.empty()) return result;
+
+    const Player mover    = board.sideToMove();
+    const Player opponent = otherPlayer(mover);
+
+    std::atomic<bool>        cancel{false};
+    std::atomic<std::size_t> nextMove{0};
+    std::atomic<int>         winIndex{-1};
+    ThreatSearchLimits taskLimits = limits;
+    taskLimits.abortFlag      = &cancel;
+    taskLimits.extraAbortFlag = limits.abortFlag;  // the caller's stop reaches running tasks
 
-        if (isImmediateWinningMove(tmp, m, attacker)) {
-            winningMoves.push_back(m);
+    auto worker = [&]() {
+        Board local = board;
+        ThreatSolver solver(*this);
+        solver.syncFromBoard(local);
+        for (;;) {
+            if (limits.abortFlag && limits.abortFlag->load(std::memory_order_relaxed)) {
+                cancel.store(true, std::memory_order_relaxed);
+            }
+            if (cancel.load(std::memory_order_relaxed)) return;
+            const std::size_t i = nextMove.fetch_add(1, std::memory_order_relaxed);
+            if (i >= moves.size()) return;
+
+            const Move m = moves[i];
+            if (!local.makeMove(m.x, m.y)) continue;
+            solver.notifyMove(m);
+
+            RootMoveProof proof = RootMoveProof::Unknown;
+            ThreatSequence seq;
+            if (local.checkWinAt(m.x, m.y)) {
+                proof = RootMoveProof::Win;
+            } else if (solver.findWinningThreatSequence(opponent, seq, taskLimits)) {
+                proof = RootMoveProof::Loss;
+            } else if (solver.computeDefensiveSet(opponent, taskLimits).isLost) {
+                proof = RootMoveProof::Win;
+            }
+
+            local.unmakeMove(m.x, m.y);
+            solver.notifyUndo(m);
+
+            // Each worker writes only the slots it claimed.
+            result.proofs[i] = proof;
+            if (proof == RootMoveProof::Win) {
+                int none = -1;
+                winIndex.compare_exchange_strong(none, static_cast<int>(i));
+                cancel.store(true, std::memory_order_relaxed);
+            }
         }
+    };
+
+    const std::size_t workers =
+        std::min(moves.size(), static_cast<std::size_t>(std::max(1, threads)));
+    std::vector<std::thread> pool;
+    pool.reserve(workers - 1);
+    for (std::size_t t = 1; t < workers; ++t) pool.emplace_back(worker);
+    worker();
+    for (std::thread& t : pool) t.join();
+
+    const int win = winIndex.load();
+    if (win >= 0) {
+        result.foundWin    = true;
+        result.winningMove = moves[static_cast<std::size_t>(win)];
     }
+    result.allLost = std::all_of(result.proofs.begin(), result.proofs.end(),
+                                 [](RootMoveProof p) { return p == RootMoveProof::Loss; });
+    return result;
+}
+
+std::unique_ptr<IThreatSolver> ThreatSolver::clone(const Board& board) const {
+    std::unique_ptr<ThreatSolver> copy(new ThreatSolver(*this));
+    copy->syncFromBoard(board);
+    return copy;
+}
+
+bool ThreatSolver::hasImmediateWinningThreat(Player player) const {
+    if (!impl_->rootBoard) return false;
 
-    if (winningMoves.empty()) {
-        // No immediate wins for opponent.
-        result.isLost = false;
-        // defensiveMoves left empty ⇒ search engine can expand all legal moves.
-        return result;
+    // 1) Already-winning position (five on board).
+    if (impl_->rootBoard->checkWin(player)) {
+        return true;
     }
 
-    if (winningMoves.size() == 1) {
-        // Single winning move: defender must block it.
-        result.isLost = false;
-        result.defensiveMoves.push_back(winningMoves.front());
-        return result;
+    // 2) Any immediate winning move?  The threat board already knows which
+    //    cells complete a five.
+    const int p = playerIndex(player);
+    for (int y = 0; y < GOMOKU_BOARD_SIZE; ++y) {
+        for (int x = 0; x < GOMOKU_BOARD_SIZE; ++x) {
+            for (int d = 0; d < 4; ++d) {
+                if (impl_->threats.cells[p][y][x][d].type == ThreatType::Five) {
+                    return true;
+                }
+            }
+        }
     }
+    return false;
+}
 
-    // Multiple distinct immediate wins → position is lost.
-    result.isLost = true;
-    return result;
+void ThreatSolver::collectCurrentForcingThreats(Player player,
+                                                std::vector<ThreatInstance>& out) const {
+    if (!impl_->rootBoard) return;
+
+    const int p = playerIndex(player);
+    for (int y = 0; y < GOMOKU_BOARD_SIZE; ++y) {
+        for (int x = 0; x < GOMOKU_BOARD_SIZE; ++x) {
+            for (int d = 0; d < 4; ++d) {
+                const ThreatCell& cell = impl_->threats.cells[p][y][x][d];
+                if (!isForcingOrWinning(cell.type)) continue;
+                ThreatInstance t;
+                if (buildThreatInstance(*impl_->rootBoard, player, Move(x, y), d,
+                                        cell.patternId, t)) {
+                    out.push_back(std::move(t));
+                }
+            }
+        }
+    }
 }
 
 } // namespace gomoku
\ No newline at end of file
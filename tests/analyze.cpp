@@ -0,0 +1,110 @@
+/**
+ * Batch position analysis.
+ *
+ * Reads positions and analyses them on an AnalysisService worker pool,
+ * writing one result line per position to stdout in input order:
+ *
+ *   <id> <best-move> <score> <depth> <nodes> <mate|-> <pv...>
+ *
+ * where <id> is the input line number (text) or record number (packed).
+ *
+ * Scores are from the perspective of the side to move.  Input is either a
+ * text stream on stdin, one move-list position per line (cells after the
+ * opening cross, e.g. "e5 h8 e4"; blank lines and lines starting with '#'
+ * are skipped), or with --packed a file of 37-byte packed positions (see
+ * core/position_codec.h).
+ *
+ * Usage: analyze [--workers N] [--ms N] [--depth N] [--nodes N] [--hash MB]
+ *                [--packed FILE]
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "analysis_service.h"
+#include "core/position_codec.h"
+
+using namespace gomoku;
+
+namespace {
+
+void printResult(const AnalysisResult& r) {
+    const SearchResult& s = r.result;
+    std::string line = std::to_string(r.id) + ' ' +
+                       (s.bestMove.x < 0 ? std::string("-") : cellName(s.bestMove)) + ' ' +
+                       std::to_string(s.bestScore) + ' ' +
+                       std::to_string(s.depthReached) + ' ' +
+                       std::to_string(s.nodes + s.qnodes) + ' ' +
+                       (s.isMate ? "mate" : "-");
+    for (const Move& m : s.principalVariation) line += ' ' + cellName(m);
+    line += '\n';
+    std::fputs(line.c_str(), stdout);
+}
+
+} // unnamed namespace
+
+int main(int argc, char** argv) {
+    int workers = 1;
+    std::size_t hashMB = TranspositionTable::kDefaultSizeMB;
+    std::string packedPath;
+    SearchLimits limits;
+    limits.timeLimitMs = 1000;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string arg = argv[i];
+        const char* value = argv[i + 1];
+        if      (arg == "--workers") workers = std::atoi(value);
+        else if (arg == "--ms")      limits.timeLimitMs = std::strtoull(value, nullptr, 10);
+        else if (arg == "--depth")   limits.maxDepth = std::atoi(value);
+        else if (arg == "--nodes")   limits.maxNodes = std::strtoull(value, nullptr, 10);
+        else if (arg == "--hash")    hashMB = static_cast<std::size_t>(std::strtoull(value, nullptr, 10));
+        else if (arg == "--packed")  packedPath = value;
+        else {
+            std::fprintf(stderr, "usage: %s [--workers N] [--ms N] [--depth N] [--nodes N] "
+                                 "[--hash MB] [--packed FILE]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    AnalysisService service(workers, printResult, hashMB);
+    std::uint64_t bad = 0;
+
+    if (!packedPath.empty()) {
+        std::FILE* f = std::fopen(packedPath.c_str(), "rb");
+        if (!f) {
+            std::fprintf(stderr, "Cannot read %s\n", packedPath.c_str());
+            return 1;
+        }
+        unsigned char record[kPackedPositionSize];
+        for (std::uint64_t n = 0; std::fread(record, 1, sizeof(record), f) == sizeof(record); ++n) {
+            AnalysisJob job;
+            job.id     = n;
+            job.limits = limits;
+            if (!unpackPosition(record, job.board)) {
+                std::fprintf(stderr, "Record %llu: bad position\n", static_cast<unsigned long long>(n));
+                ++bad;
+                continue;
+            }
+            service.submit(std::move(job));
+        }
+        std::fclose(f);
+    } else {
+        std::string text;
+        for (std::uint64_t n = 1; std::getline(std::cin, text); ++n) {
+            if (text.empty() || text[0] == '#') continue;
+            AnalysisJob job;
+            job.id     = n;
+            job.limits = limits;
+            if (!parseMoveList(text, job.board)) {
+                std::fprintf(stderr, "Line %llu: bad move list\n", static_cast<unsigned long long>(n));
+                ++bad;
+                continue;
+            }
+            service.submit(std::move(job));
+        }
+    }
+    service.finish();
+    return bad ? 1 : 0;
+}
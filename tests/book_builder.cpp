@@ -0,0 +1,121 @@
+/**
+ * Opening book builder.
+ *
+ * Plays self-play games from the fixed opening cross and records, for the
+ * first plies of every game, the position, the move the engine chose and
+ * its search score.  The samples are merged into the book file (an
+ * existing book at that path is read first and grown), so the book can be
+ * built up over several runs.
+ *
+ * The first RANDOM_PLIES moves of each game are drawn at random from the
+ * candidate moves (after the engine's choice has been recorded) so that
+ * the games, and the book, cover more than one line.
+ *
+ * Usage: book_builder <book-file> [games] [book-plies] [ms-per-move] [seed]
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+#include "core/board.h"
+#include "search_engine.h"
+#include "search/evaluator.h"
+#include "search/history_heuristic.h"
+#include "search/opening_book.h"
+#include "tactics/threat_solver.h"
+
+using namespace gomoku;
+
+namespace {
+
+// Random moves at the start of each game.
+static const int RANDOM_PLIES = 2;
+
+// Samples whose score says the game is already decided are not book moves.
+static const int MAX_BOOK_SCORE = 20000;
+
+struct Options {
+    std::string path;
+    int games = 100;
+    int bookPlies = 12;
+    int moveTimeMs = 200;
+    unsigned seed = 1;
+};
+
+// Play one game, adding the book-ply samples to 'builder'.  Returns the
+// number of moves played.
+int playGame(const Options& opt, std::mt19937& rng, OpeningBookBuilder& builder) {
+    Board board;
+    PatternEvaluator evaluator(board);
+    ThreatSolver threats(board);
+    HistoryHeuristic history;
+    SearchEngine engine(board, evaluator, &threats, &history);
+
+    int ply = 0;
+    while (ply < 144) {
+        MoveList candidates;
+        board.getCandidateMoves(candidates);
+        if (candidates.empty()) break;
+
+        SearchLimits limits;
+        limits.timeLimitMs = static_cast<std::uint64_t>(opt.moveTimeMs);
+        const SearchResult r = engine.searchBestMove(limits);
+        Move move = r.bestMove;
+        if (move.x < 0 || board.isOccupied(move.x, move.y)) move = candidates.front();
+        if (ply < opt.bookPlies && !r.isMate &&
+            r.bestScore > -MAX_BOOK_SCORE && r.bestScore < MAX_BOOK_SCORE) {
+            builder.add(board, move, r.bestScore);
+        }
+        if (ply < RANDOM_PLIES) move = candidates[rng() % candidates.size()];
+
+        board.makeMove(move.x, move.y);
+        threats.notifyMove(move);
+        ++ply;
+        if (board.checkWinAt(move.x, move.y)) break;
+    }
+    return ply;
+}
+
+} // unnamed namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr,
+                     "usage: %s <book-file> [games] [book-plies] [ms-per-move] [seed]\n",
+                     argv[0]);
+        return 2;
+    }
+    Options opt;
+    opt.path = argv[1];
+    if (argc > 2) opt.games      = std::atoi(argv[2]);
+    if (argc > 3) opt.bookPlies  = std::atoi(argv[3]);
+    if (argc > 4) opt.moveTimeMs = std::atoi(argv[4]);
+    if (argc > 5) opt.seed       = static_cast<unsigned>(std::strtoul(argv[5], nullptr, 10));
+
+    OpeningBookBuilder builder;
+    {
+        OpeningBook existing;
+        if (existing.open(opt.path)) {
+            builder.add(existing);
+            std::printf("Extending %s (%zu records)\n", opt.path.c_str(), existing.size());
+        }
+    } // unmapped before the file is rewritten
+
+    std::mt19937 rng(opt.seed);
+    for (int g = 0; g < opt.games; ++g) {
+        const int plies = playGame(opt, rng, builder);
+        std::printf("Game %d/%d: %d moves, %zu samples\n", g + 1, opt.games, plies, builder.size());
+        std::fflush(stdout);
+    }
+
+    if (!builder.write(opt.path)) {
+        std::fprintf(stderr, "Cannot write %s\n", opt.path.c_str());
+        return 1;
+    }
+    OpeningBook book;
+    if (book.open(opt.path)) std::printf("Wrote %s: %zu records\n", opt.path.c_str(), book.size());
+    return 0;
+}
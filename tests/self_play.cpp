@@ -1,123 +1,448 @@
 /**
- * Self‑play test harness for the Gomoku engine.
+ * Headless self-play match runner.
  *
- * This utility links directly against the existing board and search engine
- * implementation to simulate a full game where the engine plays both
- * sides.  After each move, the current board state is printed to the
- * terminal using simple ASCII graphics.  Black stones are shown as
- * ‘B’, white stones as ‘W’ and empty cells as ‘.’.  Coordinates are
- * labeled along the top and left edges to aid human readability.
+ * Plays a match of N games between two engine configurations, A and B,
+ * over a pool of worker threads (one game per worker at a time, every game
+ * with its own engines, boards and tables).  Games come in pairs that share
+ * an opening: A plays Black in the first game of a pair and White in the
+ * second.  The opening is the fixed cross, optionally followed by a few
+ * random candidate moves (--random-plies), the same for both games of a
+ * pair.
  *
- * The starting position uses the standard fixed opening cross: white
- * stones at (6,6) and (5,5) and black stones at (6,5) and (5,6).  The
- * engine plays until one side achieves five in a row or the board
- * becomes full.  A per‑move time limit can be adjusted via the
- * constant TIME_LIMIT_MS below.
+ * Output:
+ *   - one PGN-like record per game (tag pairs and the move list, cells as
+ *     column letter a-l for x and row number 1-12 for y) on stdout or in
+ *     --pgn <file>;
+ *   - optionally one line per engine move in --stats <file>: game, ply,
+ *     engine, side, move, score, depth, nodes, qnodes, time, NPS and the
+ *     mate, book and illegal flags, as CSV or as JSON lines
+ *     (--format csv|jsonl);
+ *   - a summary (wins, draws, score, mean depth and NPS per engine).
+ *
+ * An engine that returns no move or an occupied cell forfeits the game.
+ * The record says so in a Termination tag, the move is flagged in the
+ * stats ("illegal"), and the summary counts the forfeits per engine.
+ *
+ * An engine configuration is a comma-separated list of key=value pairs:
+ *   ms=<n>       time per move (default 200)
+ *   depth=<n>    maximum depth (default 32)
+ *   nodes=<n>    node budget per move, 0 = none (default 0)
+ *   hash=<n>     transposition table MB (default 16)
+ *   threads=<n>  search threads per engine (default 1)
+ *   null=0|1     null-move pruning (default 1)
+ *   panic=0|1    panic time (default 1)
+ *   proofs=0|1   root threat proofs (default 0)
+ *   dfpn=<n>     full-width df-pn confirmation budget in nodes, 0 = off
+ *                (default 0; 100000 proves most threat-search wins)
+ *   threats=0|1  use the threat solver (default 1)
+ *   history=0|1  use the history heuristic (default 1)
+ *   book=<file>  opening book (default none)
+ *
+ * Usage: self_play [--games N] [--concurrency N] [--random-plies N]
+ *                  [--seed S] [--a SPEC] [--b SPEC] [--pgn FILE]
+ *                  [--stats FILE] [--format csv|jsonl]
  */
 
-#include <iostream>
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
 #include <thread>
-#include <locale>
+#include <vector>
 
-#include "board.h"
-#include "search.h"
+#include "core/board.h"
+#include "core/position_codec.h"
+#include "search_engine.h"
+#include "search/evaluator.h"
+#include "search/history_heuristic.h"
+#include "search/opening_book.h"
+#include "tactics/threat_solver.h"
 
 using namespace gomoku;
 
 namespace {
 
-// Per‑move time limit in milliseconds.  Adjust this value to
-// shorten or lengthen the thinking time allowed for each move.
-static const int TIME_LIMIT_MS = 2000;
-
-// Helper function to print the current board state.  It labels the
-// columns with x‑coordinates along the top and rows with y‑coordinates
-// along the left.  Empty squares are denoted by '.', black stones by
-// 'B' and white stones by 'W'.
-void printBoard(const Board &board) {
-    // Print column headers
-    std::cout << "   ";
-    for (int x = 0; x < 12; ++x) {
-        // Align single‑digit numbers for neatness
-        if (x < 10) std::cout << ' ';
-        std::cout << x << ' ';
-    }
-    std::cout << '\n';
-    for (int y = 0; y < 12; ++y) {
-        // Row header
-        if (y < 10) std::cout << ' ';
-        std::cout << y << ' ';
-        for (int x = 0; x < 12; ++x) {
-            int cell = board.getCellState(x, y);
-            char c = '.';
-            if (cell == 1)      c = 'B';
-            else if (cell == 2) c = 'W';
-            std::cout << ' ' << c;
+// Safety cap on game length; a full board ends the game first (a draw).
+static const int MAX_PLIES = 144;
+
+struct EngineConfig {
+    std::string   name;
+    SearchLimits  limits;
+    bool          useThreats = true;
+    bool          useHistory = true;
+    std::string   bookPath;
+};
+
+struct Options {
+    int          games = 2;
+    int          concurrency = 1;
+    int          randomPlies = 0;
+    unsigned     seed = 1;
+    EngineConfig engines[2];
+    std::string  pgnPath;
+    std::string  statsPath;
+    bool         jsonl = false;
+};
+
+struct MoveStats {
+    Move          move;
+    int           engine = 0;    // 0 = A, 1 = B; -1 for an opening move
+    Player        side = Player::Black;
+    EvalScore     score = 0;     // from the mover's perspective
+    int           depth = 0;
+    std::uint64_t nodes = 0;
+    std::uint64_t qnodes = 0;
+    double        timeMs = 0.0;
+    bool          mate = false;
+    bool          book = false;
+    bool          illegal = false;  // no move, or an occupied cell: a forfeit
+};
+
+struct GameRecord {
+    int                    index = 0;
+    int                    blackEngine = 0;  // engine index playing Black
+    int                    winner = -1;      // engine index, -1 = draw
+    int                    forfeit = -1;     // engine index that moved illegally
+    std::vector<MoveStats> moves;
+};
+
+// One engine with all of its dependencies, bound to its own board.
+struct Contestant {
+    Board                             board;
+    PatternEvaluator                  evaluator;
+    std::unique_ptr<ThreatSolver>     threats;
+    std::unique_ptr<HistoryHeuristic> history;
+    std::unique_ptr<SearchEngine>     engine;
+
+    Contestant(const EngineConfig& cfg, const OpeningBook* book) : evaluator(board) {
+        if (cfg.useThreats) threats.reset(new ThreatSolver(board));
+        if (cfg.useHistory) history.reset(new HistoryHeuristic());
+        engine.reset(new SearchEngine(board, evaluator, threats.get(), history.get()));
+        if (cfg.limits.ttSizeMB) engine->setHashSizeMB(cfg.limits.ttSizeMB);
+        engine->setOpeningBook(book);
+    }
+
+    void play(const Move& m) {
+        board.makeMove(m.x, m.y);
+        if (threats) threats->notifyMove(m);
+    }
+};
+
+// The opening of pair 'pair': random candidate moves after the cross.
+std::vector<Move> makeOpening(const Options& opt, int pair) {
+    std::vector<Move> opening;
+    std::mt19937 rng(opt.seed * 7919u + static_cast<unsigned>(pair));
+    Board board;
+    for (int i = 0; i < opt.randomPlies; ++i) {
+        MoveList candidates;
+        board.getCandidateMoves(candidates);
+        if (candidates.empty()) break;
+        const Move m = candidates[rng() % candidates.size()];
+        board.makeMove(m.x, m.y);
+        if (board.checkWinAt(m.x, m.y)) {
+            board.unmakeMove(m.x, m.y);
+            break;
         }
-        std::cout << '\n';
+        opening.push_back(m);
     }
+    return opening;
 }
 
-} // unnamed namespace
+GameRecord playGame(const Options& opt, int index,
+                    const OpeningBook* const books[2]) {
+    GameRecord game;
+    game.index       = index;
+    game.blackEngine = index % 2;
 
-int main() {
-    std::locale::global(std::locale("en_US.UTF-8"));
-    std::cout.imbue(std::locale());
-    Board board;
-    SearchEngine engine;
-    int moveCount = 0;
-
-    std::cout << "Starting self‑play game. Initial board:\n";
-    printBoard(board);
-    std::cout << std::flush;
-
-    // Continue until one player wins or the board is full.
-    while (true) {
-        // Determine current player
-        Player current = board.sideToMove();
-        // Check if either player has already won (possible due to forced
-        // win detection routines inside SearchEngine).  Also handle
-        // completion when the board has no legal moves left.
-        bool blackWin = board.checkWin(Player::Black);
-        bool whiteWin = board.checkWin(Player::White);
-        if (blackWin || whiteWin) {
-            std::cout << (blackWin ? "Black" : "White") << " wins!\n";
+    // Per game, not per match: the engines keep their tables move to move.
+    Contestant a(opt.engines[0], books[0]);
+    Contestant b(opt.engines[1], books[1]);
+    Contestant* players[2] = {&a, &b};
+
+    for (const Move& m : makeOpening(opt, index / 2)) {
+        MoveStats s;
+        s.move   = m;
+        s.engine = -1;
+        s.side   = a.board.sideToMove();
+        game.moves.push_back(s);
+        a.play(m);
+        b.play(m);
+    }
+
+    while (static_cast<int>(game.moves.size()) < MAX_PLIES) {
+        const Player side = a.board.sideToMove();
+        const int e = (side == Player::Black) ? game.blackEngine : 1 - game.blackEngine;
+        Contestant& p = *players[e];
+
+        MoveList candidates;
+        p.board.getCandidateMoves(candidates);
+        if (candidates.empty()) break;
+
+        const auto start = std::chrono::steady_clock::now();
+        const SearchResult r = p.engine->searchBestMove(opt.engines[e].limits);
+        const auto stop = std::chrono::steady_clock::now();
+
+        MoveStats s;
+        s.move   = r.bestMove;
+        s.engine = e;
+        s.side   = side;
+        s.score  = r.bestScore;
+        s.depth  = r.depthReached;
+        s.nodes  = r.nodes;
+        s.qnodes = r.qnodes;
+        s.timeMs = std::chrono::duration<double, std::milli>(stop - start).count();
+        s.mate   = r.isMate;
+        s.book   = r.isBookMove;
+        s.illegal = s.move.x < 0 || s.move.x >= 12 || s.move.y < 0 || s.move.y >= 12 ||
+                    p.board.isOccupied(s.move.x, s.move.y);
+        game.moves.push_back(s);
+        if (s.illegal) {
+            game.forfeit = e;
+            game.winner  = 1 - e;
             break;
         }
-        auto legal = board.getLegalMoves();
-        if (legal.empty()) {
-            std::cout << "No more legal moves – draw or stalemate.\n";
+
+        a.play(s.move);
+        b.play(s.move);
+        if (a.board.checkWinAt(s.move.x, s.move.y)) {
+            game.winner = e;
             break;
         }
+    }
+    return game;
+}
+
+// Cell name, or "-" for a move off the board (an engine that gave none).
+std::string moveName(const Move& m) {
+    return (m.x < 0 || m.x >= 12 || m.y < 0 || m.y >= 12) ? std::string("-") : cellName(m);
+}
+
+std::string pgnRecord(const Options& opt, const GameRecord& g) {
+    const char* result = g.winner < 0 ? "1/2-1/2"
+                       : (g.winner == g.blackEngine ? "1-0" : "0-1");
+    std::ostringstream out;
+    out << "[Game \"" << g.index + 1 << "\"]\n"
+        << "[Black \"" << opt.engines[g.blackEngine].name << "\"]\n"
+        << "[White \"" << opt.engines[1 - g.blackEngine].name << "\"]\n"
+        << "[Opening \"" << opt.randomPlies << "\"]\n"
+        << "[Plies \"" << g.moves.size() - (g.forfeit >= 0 ? 1 : 0) << "\"]\n"
+        << "[Result \"" << result << "\"]\n";
+    if (g.forfeit >= 0) {
+        out << "[Termination \"illegal move " << moveName(g.moves.back().move) << " by "
+            << opt.engines[g.forfeit].name << "\"]\n";
+    }
+    for (std::size_t i = 0; i < g.moves.size(); ++i) {
+        if (g.moves[i].illegal) break;
+        if (i % 2 == 0) out << (i / 2 + 1) << ". ";
+        out << cellName(g.moves[i].move) << ' ';
+    }
+    out << result << "\n\n";
+    return out.str();
+}
+
+std::uint64_t npsOf(const MoveStats& s) {
+    if (s.timeMs <= 0.0) return 0;
+    return static_cast<std::uint64_t>(static_cast<double>(s.nodes + s.qnodes) * 1000.0 / s.timeMs);
+}
+
+void writeStats(std::FILE* f, const Options& opt, const GameRecord& g) {
+    for (std::size_t i = 0; i < g.moves.size(); ++i) {
+        const MoveStats& s = g.moves[i];
+        if (s.engine < 0) continue;
+        const char* engine = opt.engines[s.engine].name.c_str();
+        const char* side   = s.side == Player::Black ? "black" : "white";
+        const std::string move = moveName(s.move);
+        if (opt.jsonl) {
+            std::fprintf(f,
+                "{\"game\":%d,\"ply\":%zu,\"engine\":\"%s\",\"side\":\"%s\",\"move\":\"%s\","
+                "\"score\":%d,\"depth\":%d,\"nodes\":%llu,\"qnodes\":%llu,\"time_ms\":%.2f,"
+                "\"nps\":%llu,\"mate\":%s,\"book\":%s,\"illegal\":%s}\n",
+                g.index + 1, i + 1, engine, side, move.c_str(), s.score, s.depth,
+                static_cast<unsigned long long>(s.nodes),
+                static_cast<unsigned long long>(s.qnodes), s.timeMs,
+                static_cast<unsigned long long>(npsOf(s)),
+                s.mate ? "true" : "false", s.book ? "true" : "false",
+                s.illegal ? "true" : "false");
+        } else {
+            std::fprintf(f, "%d,%zu,%s,%s,%s,%d,%d,%llu,%llu,%.2f,%llu,%d,%d,%d\n",
+                g.index + 1, i + 1, engine, side, move.c_str(), s.score, s.depth,
+                static_cast<unsigned long long>(s.nodes),
+                static_cast<unsigned long long>(s.qnodes), s.timeMs,
+                static_cast<unsigned long long>(npsOf(s)),
+                s.mate ? 1 : 0, s.book ? 1 : 0, s.illegal ? 1 : 0);
+        }
+    }
+}
+
+bool parseEngine(const std::string& spec, EngineConfig& cfg) {
+    cfg.limits.timeLimitMs = 200;
+    cfg.limits.ttSizeMB    = TranspositionTable::kDefaultSizeMB;
+    std::stringstream in(spec);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        if (item.empty()) continue;
+        const std::size_t eq = item.find('=');
+        if (eq == std::string::npos) return false;
+        const std::string key = item.substr(0, eq);
+        const std::string value = item.substr(eq + 1);
+        const unsigned long long n = std::strtoull(value.c_str(), nullptr, 10);
+        if      (key == "ms")      cfg.limits.timeLimitMs = n;
+        else if (key == "depth")   cfg.limits.maxDepth = static_cast<int>(n);
+        else if (key == "nodes")   cfg.limits.maxNodes = n;
+        else if (key == "hash")    cfg.limits.ttSizeMB = static_cast<std::size_t>(n);
+        else if (key == "threads") cfg.limits.threads = static_cast<int>(n);
+        else if (key == "null")    cfg.limits.enableNullMove = n != 0;
+        else if (key == "panic")   cfg.limits.enablePanicMode = n != 0;
+        else if (key == "proofs")  cfg.limits.enableRootProofs = n != 0;
+        else if (key == "dfpn")    cfg.limits.dfpnMaxNodes = n;
+        else if (key == "threats") cfg.useThreats = n != 0;
+        else if (key == "history") cfg.useHistory = n != 0;
+        else if (key == "book")    cfg.bookPath = value;
+        else return false;
+    }
+    return true;
+}
+
+void usage(const char* prog) {
+    std::fprintf(stderr,
+        "usage: %s [--games N] [--concurrency N] [--random-plies N] [--seed S]\n"
+        "          [--a SPEC] [--b SPEC] [--pgn FILE] [--stats FILE] [--format csv|jsonl]\n"
+        "SPEC: ms=,depth=,nodes=,hash=,threads=,null=,panic=,proofs=,dfpn=,threats=,history=,book=\n",
+        prog);
+}
 
-        // Find the best move for the current player.  We pass the
-        // current player as myColor so the evaluation is from that
-        // player's perspective.  The time limit is fixed per move.
-        Move mv = engine.findBestMove(board, current, TIME_LIMIT_MS);
-        // If the engine returns an invalid move or chooses an occupied
-        // square, fall back to the first candidate move.  This guards
-        // against unexpected failures in the search code.
-        if (mv.x < 0 || mv.y < 0 || board.isOccupied(mv.x, mv.y)) {
-            if (!legal.empty()) {
-                mv = legal.front();
-            } else {
-                std::cout << "No candidate moves available.\n";
-                break;
+} // unnamed namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    opt.engines[0].name = "A";
+    opt.engines[1].name = "B";
+    std::string specs[2];
+    std::string format = "csv";
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (i + 1 >= argc) { usage(argv[0]); return 2; }
+        const char* value = argv[++i];
+        if      (arg == "--games")        opt.games = std::atoi(value);
+        else if (arg == "--concurrency")  opt.concurrency = std::atoi(value);
+        else if (arg == "--random-plies") opt.randomPlies = std::atoi(value);
+        else if (arg == "--seed")         opt.seed = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+        else if (arg == "--a")            specs[0] = value;
+        else if (arg == "--b")            specs[1] = value;
+        else if (arg == "--pgn")          opt.pgnPath = value;
+        else if (arg == "--stats")        opt.statsPath = value;
+        else if (arg == "--format")       format = value;
+        else { usage(argv[0]); return 2; }
+    }
+    for (int e = 0; e < 2; ++e) {
+        if (!parseEngine(specs[e], opt.engines[e])) {
+            std::fprintf(stderr, "Bad engine spec for %s: %s\n",
+                         opt.engines[e].name.c_str(), specs[e].c_str());
+            return 2;
+        }
+    }
+    if (format != "csv" && format != "jsonl") { usage(argv[0]); return 2; }
+    opt.jsonl = (format == "jsonl");
+    if (opt.games < 1) opt.games = 1;
+    if (opt.concurrency < 1) opt.concurrency = 1;
+
+    // Books are read-only and shared by every game of an engine.
+    OpeningBook bookStore[2];
+    const OpeningBook* books[2] = {nullptr, nullptr};
+    for (int e = 0; e < 2; ++e) {
+        if (opt.engines[e].bookPath.empty()) continue;
+        if (!bookStore[e].open(opt.engines[e].bookPath)) {
+            std::fprintf(stderr, "Cannot open book %s\n", opt.engines[e].bookPath.c_str());
+            return 1;
+        }
+        books[e] = &bookStore[e];
+    }
+
+    std::FILE* pgn = stdout;
+    if (!opt.pgnPath.empty() && !(pgn = std::fopen(opt.pgnPath.c_str(), "w"))) {
+        std::fprintf(stderr, "Cannot write %s\n", opt.pgnPath.c_str());
+        return 1;
+    }
+    std::FILE* stats = nullptr;
+    if (!opt.statsPath.empty()) {
+        if (!(stats = std::fopen(opt.statsPath.c_str(), "w"))) {
+            std::fprintf(stderr, "Cannot write %s\n", opt.statsPath.c_str());
+            return 1;
+        }
+        if (!opt.jsonl) {
+            std::fprintf(stats, "game,ply,engine,side,move,score,depth,nodes,qnodes,time_ms,nps,mate,book,illegal\n");
+        }
+    }
+
+    // Workers take game indices in order and write each record as soon as
+    // its game ends.
+    std::vector<GameRecord> records(static_cast<std::size_t>(opt.games));
+    std::atomic<int> nextGame{0};
+    std::mutex outputMutex;
+    auto worker = [&]() {
+        for (;;) {
+            const int g = nextGame.fetch_add(1);
+            if (g >= opt.games) return;
+            GameRecord rec = playGame(opt, g, books);
+            std::lock_guard<std::mutex> lock(outputMutex);
+            const std::string text = pgnRecord(opt, rec);
+            std::fputs(text.c_str(), pgn);
+            std::fflush(pgn);
+            if (stats) {
+                writeStats(stats, opt, rec);
+                std::fflush(stats);
             }
+            records[static_cast<std::size_t>(g)] = std::move(rec);
         }
-        // Apply the move to the board.
-        board.makeMove(mv.x, mv.y);
-        ++moveCount;
-        std::cout << "Move " << moveCount << ": "
-                  << (current == Player::Black ? "Black" : "White")
-                  << " plays (" << mv.x << "," << mv.y << ")\n";
-        printBoard(board);
-        std::cout << std::flush;
-
-        // Brief pause between moves for readability.  Comment out if
-        // continuous output is preferred.
-        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    };
+    const int workers = std::min(opt.concurrency, opt.games);
+    std::vector<std::thread> pool;
+    for (int i = 0; i < workers; ++i) pool.emplace_back(worker);
+    for (std::thread& t : pool) t.join();
+
+    if (pgn != stdout) std::fclose(pgn);
+    if (stats) std::fclose(stats);
+
+    // Summary.
+    int wins[2] = {0, 0};
+    int forfeits[2] = {0, 0};
+    int draws = 0;
+    std::uint64_t moves[2] = {0, 0};
+    std::uint64_t depthSum[2] = {0, 0};
+    std::uint64_t nodeSum[2] = {0, 0};
+    double timeSum[2] = {0.0, 0.0};
+    for (const GameRecord& g : records) {
+        if (g.winner < 0) ++draws;
+        else ++wins[g.winner];
+        if (g.forfeit >= 0) ++forfeits[g.forfeit];
+        for (const MoveStats& s : g.moves) {
+            if (s.engine < 0 || s.book) continue;
+            ++moves[s.engine];
+            depthSum[s.engine] += static_cast<std::uint64_t>(s.depth);
+            nodeSum[s.engine]  += s.nodes + s.qnodes;
+            timeSum[s.engine]  += s.timeMs;
+        }
+    }
+    std::printf("Games %d: A %d, B %d, draws %d, A score %.1f%%\n",
+                 opt.games, wins[0], wins[1], draws,
+                 100.0 * (wins[0] + 0.5 * draws) / opt.games);
+    for (int e = 0; e < 2; ++e) {
+        const double n = moves[e] ? static_cast<double>(moves[e]) : 1.0;
+        std::printf("%s: %llu moves, mean depth %.2f, mean time %.1f ms, %.0f nps, "
+                    "%d illegal-move forfeits\n",
+                     opt.engines[e].name.c_str(),
+                     static_cast<unsigned long long>(moves[e]),
+                     static_cast<double>(depthSum[e]) / n, timeSum[e] / n,
+                     timeSum[e] > 0.0 ? static_cast<double>(nodeSum[e]) * 1000.0 / timeSum[e] : 0.0,
+                     forfeits[e]);
     }
     return 0;
-}
\ No newline at end of file
+}
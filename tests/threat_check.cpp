@@ -0,0 +1,91 @@
+/**
+ * Threat solver regression check.
+ *
+ * Plays random candidate moves from the opening cross to build positions
+ * in which neither side has a four on the board, and keeps those where the
+ * side to move has a one-move win: a stone that leaves two five squares.
+ * ThreatSolver::analyzeThreats() must report a forced win for every one of
+ * them.  Each miss is printed as "<winning cell>: <move list>" (the move
+ * list in the format tests/analyze reads) and makes the exit status 1.
+ *
+ * Usage: threat_check [positions] [seed]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+#include "core/board.h"
+#include "core/position_codec.h"
+#include "tactics/threat_solver.h"
+
+using namespace gomoku;
+
+namespace {
+
+int fiveSquares(const Board& board, Player player) {
+    int n = 0;
+    for (const Move& m : board.emptyCells()) {
+        if (board.isWinningMove(m.x, m.y, player)) ++n;
+    }
+    return n;
+}
+
+// A random position with no four for either side, or false.  'moves' gets
+// its move list.
+bool randomPosition(std::mt19937& rng, Board& board, std::string& moves) {
+    board = Board();
+    moves.clear();
+    const int plies = 8 + static_cast<int>(rng() % 40);
+    for (int i = 0; i < plies; ++i) {
+        MoveList candidates;
+        board.getCandidateMoves(candidates);
+        if (candidates.empty()) return false;
+        const Move m = candidates[rng() % candidates.size()];
+        board.makeMove(m.x, m.y);
+        moves += (i ? " " : "") + cellName(m);
+        if (board.checkWinAt(m.x, m.y)) return false;
+    }
+    return fiveSquares(board, Player::Black) == 0 && fiveSquares(board, Player::White) == 0;
+}
+
+// A move of 'player' that leaves two five squares, or (-1,-1).
+Move openFourMove(Board& board, Player player) {
+    for (const Move& m : board.emptyCells()) {
+        board.placeStone(m.x, m.y, player);
+        const bool wins = fiveSquares(board, player) >= 2;
+        board.removeStone(m.x, m.y, player);
+        if (wins) return m;
+    }
+    return Move(-1, -1);
+}
+
+} // unnamed namespace
+
+int main(int argc, char** argv) {
+    const int positions = argc > 1 ? std::atoi(argv[1]) : 3000;
+    const unsigned seed = argc > 2 ? static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10)) : 1U;
+    std::mt19937 rng(seed);
+
+    int tried = 0;
+    int wins = 0;
+    int missed = 0;
+    Board board;
+    std::string moves;
+    while (tried < positions) {
+        if (!randomPosition(rng, board, moves)) continue;
+        ++tried;
+        const Player mover = board.sideToMove();
+        const Move win = openFourMove(board, mover);
+        if (win.x < 0) continue;
+        ++wins;
+        ThreatSolver solver(board);
+        if (!solver.analyzeThreats(board, mover).attackerHasForcedWin) {
+            ++missed;
+            std::printf("%s: %s\n", cellName(win).c_str(), moves.c_str());
+        }
+    }
+    std::printf("%d positions, %d one-move wins, %d missed\n", tried, wins, missed);
+    return missed ? 1 : 0;
+}